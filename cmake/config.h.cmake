@@ -3,6 +3,9 @@
 
 #cmakedefine HAVE_GCC_VISIBILITY
 #cmakedefine HAVE_OCICLIENTVERSION
+#cmakedefine HAVE_OCILOBREAD2
 #cmakedefine HAVE_OCILOBWRITE2
+#cmakedefine HAVE_OCILOBARRAYREAD
+#cmakedefine HAVE_OCILOBARRAYWRITE
 
 #endif
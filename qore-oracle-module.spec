@@ -1,4 +1,4 @@
-%define mod_ver 3.3.2
+%define mod_ver 3.4
 
 %{?_datarootdir: %global mydatarootdir %_datarootdir}
 %{!?_datarootdir: %global mydatarootdir /usr/share}
@@ -23,7 +23,9 @@
 
 #include "oracle.h"
 
-static DateTimeNode* convert_date_time(unsigned char *str) {
+// the time zone is passed explicitly, as dates can also be converted in threads other than the thread using the
+// connection
+static DateTimeNode* convert_date_time(const unsigned char *str, const AbstractQoreZoneInfo* zone) {
     int year;
     if ((str[0] < 100) || (str[1] < 100))
         year = 9999;
@@ -31,7 +33,7 @@ static DateTimeNode* convert_date_time(unsigned char *str) {
         year = (str[0] - 100) * 100 + (str[1] - 100);
 
     //printd(5, "convert_date_time(): %d %d = %04d-%02d-%02d %02d:%02d:%02d\n", str[0], str[1], year, str[2], str[3], str[4] - 1, str[5] - 1, str[6] - 1);
-    return new DateTimeNode(year, str[2], str[3], str[4] - 1, str[5] - 1, str[6] - 1);
+    return DateTimeNode::makeAbsolute(zone, year, str[2], str[3], str[4] - 1, str[5] - 1, str[6] - 1);
 }
 
 void OraColumnValue::del(ExceptionSink *xsink) {
@@ -65,6 +67,10 @@ void OraColumnValue::del(ExceptionSink *xsink) {
 
         case SQLT_CLOB:
         case SQLT_BLOB:
+            if (lob_long) {
+                delete buf.lng;
+                break;
+            }
             if (buf.ptr)
                 OCIDescriptorFree(buf.ptr, OCI_DTYPE_LOB);
             break;
@@ -102,6 +108,12 @@ void OraColumnValue::del(ExceptionSink *xsink) {
         case SQLT_BIN:
         case SQLT_LBI:
         case SQLT_LVB: {
+            // binary columns defined with a return length use plain buffers
+            if (use_rlen) {
+                if (buf.ptr)
+                    free(buf.ptr);
+                break;
+            }
             QoreOracleConnection *conn = stmt.getData();
             //printd(5, "freeing binary pointer for SQLT_LVB %p\n", buf.ptr);
             conn->rawFree((OCIRaw**)&buf.ptr, xsink);
@@ -156,7 +168,7 @@ QoreValue OraColumnValue::getValue(ExceptionSink *xsink, bool horizontal, bool d
             return buf.f8;
 
         case SQLT_DAT:
-            return convert_date_time(buf.date);
+            return convert_date_time(buf.date, stmt.getData()->getZone());
 
         case SQLT_TIMESTAMP:
         case SQLT_DATE:
@@ -176,20 +188,39 @@ QoreValue OraColumnValue::getValue(ExceptionSink *xsink, bool horizontal, bool d
         case SQLT_LBI:
         case SQLT_LVB:
             //printd(5, "OraColumnValue::getValue() this=%p SQLT_LVB ptr=%p\n", this, buf.ptr);
+            if (use_rlen) {
+                BinaryNode* b = new BinaryNode;
+                b->append(buf.ptr, rlen);
+                return b;
+            }
             return stmt.getData()->getBinary((OCIRaw*)buf.ptr);
 
         case SQLT_CLOB:
-            return stmt.getData()->readClob((OCILobLocator*)buf.ptr, stmt.getEncoding(), xsink);
+            if (lob_long)
+                return buf.lng->takeValue();
+            if (stmt.getData()->getLobMode() == OPT_LOB_LOCATOR)
+                return oracle_get_lob_object(stmt.getData(), (OCILobLocator*)buf.ptr, true, stmt.getEncoding(),
+                    xsink);
+            return stmt.getData()->readClob((OCILobLocator*)buf.ptr, stmt.getEncoding(), lob_prefetch,
+                xsink);
 
         case SQLT_BLOB:
-            return stmt.getData()->readBlob((OCILobLocator*)buf.ptr, xsink);
+            if (lob_long)
+                return buf.lng->takeValue();
+            if (stmt.getData()->getLobMode() == OPT_LOB_LOCATOR)
+                return oracle_get_lob_object(stmt.getData(), (OCILobLocator*)buf.ptr, false, stmt.getEncoding(),
+                    xsink);
+            return stmt.getData()->readBlob((OCILobLocator*)buf.ptr, lob_prefetch, xsink);
 
         case SQLT_LNG:
             return buf.lng->takeValue();
 
         case SQLT_RSET: {
-            if (!alt_output) {
+            if (!alt_output && stmt.getData()->getCursorMode() == OPT_CURSOR_EAGER) {
                 QoreOracleStatement tstmt(stmt.getDatasource(), (OCIStmt*)buf.takePtr());
+                int prefetch = stmt.getData()->getCursorPrefetch();
+                if (prefetch)
+                    tstmt.setBulkPrefetch(prefetch);
                 if (horizontal)
                     return tstmt.fetchRows(xsink);
                 return tstmt.fetchColumns(false, xsink);
@@ -269,13 +300,151 @@ QoreValue OraColumnValue::getValue(ExceptionSink *xsink, bool horizontal, bool d
     // which is correct value. SQLT_AVC is for varchar and it's provided for
     // CHAR in PL/SQL too - it should be trimmed. See docs:
     //   subsection string_sizes CHAR and VARCHAR2 to Qore String
+    if (use_rlen) {
+        // the length is known; trim backwards from the end of the value
+        size_t len = rlen;
+        if (dtype == SQLT_AVC) {
+            while (len && ((const char*)buf.ptr)[len - 1] == ' ')
+                --len;
+        }
+        return new QoreStringNode((const char*)buf.ptr, len, stmt.getEncoding());
+    }
     if (/*dtype == SQLT_AFC ||*/ dtype == SQLT_AVC)
         remove_trailing_blanks((char *)buf.ptr);
     return doReturnString(destructive);
 }
 
+bool OraColumnValue::isRawType() const {
+    if (array || lob_long)
+        return false;
+
+    switch (dtype) {
+        // binary values are only copied when the length is returned in rlen
+        case SQLT_BIN:
+        case SQLT_LBI:
+        case SQLT_LVB:
+            return use_rlen;
+
+        case SQLT_TIMESTAMP:
+        case SQLT_TIMESTAMP_TZ:
+        case SQLT_TIMESTAMP_LTZ:
+        case SQLT_DATE:
+        case SQLT_INTERVAL_YM:
+        case SQLT_INTERVAL_DS:
+        case SQLT_CLOB:
+        case SQLT_BLOB:
+        case SQLT_LNG:
+        case SQLT_RSET:
+        case SQLT_NTY:
+#ifdef SQLT_RDD
+        case SQLT_RDD:
+#endif
+            return false;
+    }
+
+    return true;
+}
+
+size_t OraColumnValue::getRaw(const char*& data) const {
+    assert(isRawType());
+    assert(ind != -1);
+
+    switch (dtype) {
+        case SQLT_INT:
+        case SQLT_UIN:
+            data = (const char*)&buf.i8;
+            return sizeof(buf.i8);
+
+        case SQLT_FLT:
+#ifdef SQLT_BFLOAT
+        case SQLT_BFLOAT:
+#endif
+#ifdef SQLT_BDOUBLE
+        case SQLT_BDOUBLE:
+#endif
+#ifdef SQLT_IBFLOAT
+        case SQLT_IBFLOAT:
+#endif
+#ifdef SQLT_IBDOUBLE
+        case SQLT_IBDOUBLE:
+#endif
+            data = (const char*)&buf.f8;
+            return sizeof(buf.f8);
+
+        case SQLT_DAT:
+            data = (const char*)buf.date;
+            return sizeof(buf.date);
+    }
+
+    // numbers, strings, and binary values with a returned length
+    data = (const char*)buf.ptr;
+    return use_rlen ? rlen : strlen(data);
+}
+
+QoreValue OraColumnValue::getRawValue(const char* data, size_t len, const AbstractQoreZoneInfo* zone) const {
+    switch (dtype) {
+        case SQLT_INT:
+        case SQLT_UIN: {
+            int64 i;
+            memcpy(&i, data, sizeof(i));
+            return i;
+        }
+
+        case SQLT_FLT:
+#ifdef SQLT_BFLOAT
+        case SQLT_BFLOAT:
+#endif
+#ifdef SQLT_BDOUBLE
+        case SQLT_BDOUBLE:
+#endif
+#ifdef SQLT_IBFLOAT
+        case SQLT_IBFLOAT:
+#endif
+#ifdef SQLT_IBDOUBLE
+        case SQLT_IBDOUBLE:
+#endif
+        {
+            double f;
+            memcpy(&f, data, sizeof(f));
+            return f;
+        }
+
+        case SQLT_DAT:
+            return convert_date_time((const unsigned char*)data, zone);
+
+        case SQLT_BIN:
+        case SQLT_LBI:
+        case SQLT_LVB: {
+            BinaryNode* b = new BinaryNode;
+            b->append(data, len);
+            return b;
+        }
+
+        case SQLT_VNU:
+        case SQLT_NUM: {
+            int nopt = stmt.getData()->getNumberOption();
+            switch (nopt) {
+                case OPT_NUM_OPTIMAL:
+                    return stmt.getData()->getNumberOptimal(data);
+                case OPT_NUM_STRING:
+                    return new QoreStringNode(data, len, stmt.getEncoding());
+            }
+            assert(nopt == OPT_NUM_NUMERIC);
+            return new QoreNumberNode(data);
+        }
+    }
+
+    // string data; trailing blanks are only removed for SQLT_AVC as in getValue()
+    if (dtype == SQLT_AVC) {
+        while (len && data[len - 1] == ' ')
+            --len;
+    }
+    return new QoreStringNode(data, len, stmt.getEncoding());
+}
+
 QoreStringNode* OraColumnValue::doReturnString(bool destructive) {
     assert(!array);
+    assert(!use_rlen);
     if (!destructive)
         return new QoreStringNode((const char*)buf.ptr, stmt.getEncoding());
     int len = strlen((char*)buf.ptr);
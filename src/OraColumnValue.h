@@ -33,8 +33,10 @@ struct q_lng {
     ub2 rcode = 0;
     ub4 size = 0;
     QoreStringNode* str = nullptr;
+    // if true, the data is returned as a binary value
+    bool binary;
 
-    DLLLOCAL q_lng(const QoreEncoding* e) : enc(e) {
+    DLLLOCAL q_lng(const QoreEncoding* e, bool binary = false) : enc(e), binary(binary) {
     }
 
     DLLLOCAL ~q_lng() {
@@ -52,7 +54,14 @@ struct q_lng {
             QoreStringNode* rvstr = str;
             str = nullptr;
             rvstr->terminate(rvstr->size() + size);
-            rv = rvstr;
+            if (binary) {
+                // take the buffer for the binary value without copying
+                size_t len = rvstr->size();
+                rv = new BinaryNode(rvstr->giveBuffer(), len);
+                rvstr->deref();
+            } else {
+                rv = rvstr;
+            }
             //printd(5, "ora_value::takeLongString() returning str: %p strlen: %d size: %d rcode: %d\n", rvstr, rvstr->size(), size, rcode);
         }
 
@@ -106,8 +115,12 @@ struct OraColumnValue {
     ub2 dtype;            // Oracle datatype for value
     int subdtype;         // distinguish the SQLT_NTY subtype
     sb2 ind = 0;          // indicator value
+    ub2 rlen = 0;         // returned length for string values defined with a return length
     bool array = false;
     bool alt_output = false;
+    bool use_rlen = false; // true if string data is not terminated and rlen gives the length
+    bool lob_long = false; // true if a LOB column is fetched with a dynamic define like a LONG column
+    bool lob_prefetch = false; // true if the length of a LOB column value is prefetched with the row
 
     DLLLOCAL OraColumnValue(QoreOracleStatement& n_stmt, ub2 n_dtype = 0, int n_subdtype = SQLT_NTY_NONE) : stmt(n_stmt), dtype(n_dtype), subdtype(n_subdtype) {
         //printd(5, "OraColumnValue::OraColumnValue() this: %p\n", this);
@@ -117,6 +130,13 @@ struct OraColumnValue {
     DLLLOCAL QoreStringNode* doReturnString(bool destructive);
     DLLLOCAL void freeObject(ExceptionSink* xsink);
     DLLLOCAL QoreValue getValue(ExceptionSink* xsink, bool horizontal, bool destructive = false);
+
+    // returns true if the value can be copied from the buffer and converted later without OCI calls
+    DLLLOCAL bool isRawType() const;
+    // returns a pointer to the data of the current non-NULL value in the buffer and its length in bytes
+    DLLLOCAL size_t getRaw(const char*& data) const;
+    // converts data copied with getRaw(); string and number data must be terminated; can be called in any thread
+    DLLLOCAL QoreValue getRawValue(const char* data, size_t len, const AbstractQoreZoneInfo* zone) const;
 };
 
 #endif
@@ -34,6 +34,16 @@ static int get_char_width(const QoreEncoding *enc, int num) {
 }
 
 #define Q_LONG_BLOCK_SIZE 4096
+// the maximum piece size for dynamic fetches
+#define Q_LONG_MAX_PIECE_SIZE (1024 * 1024)
+
+// returns the size of the next piece: pieces grow with the data up to Q_LONG_MAX_PIECE_SIZE
+static ub4 q_long_piece_size(size_t size) {
+   if (size < Q_LONG_BLOCK_SIZE)
+      return Q_LONG_BLOCK_SIZE;
+   return size > Q_LONG_MAX_PIECE_SIZE ? Q_LONG_MAX_PIECE_SIZE : size;
+}
+
 static sb4 q_long_callback(q_lng* lng, OCIDefine *defnp, ub4 iter, void **bufpp, ub4 **alenpp, ub1 *piecep, void **indpp, ub2 **rcodep) {
    //printd(5, "q_long_callback() lng: %p iter: %d piece: %d alenp: %p (%d) indp: %p ind: %d size: %d str: %p\n", lng, iter, *piecep, *alenpp, *alenpp ? **alenpp : 0, *indpp, (int)lng->ind, (int)lng->size, lng->str);
 
@@ -62,8 +72,8 @@ static sb4 q_long_callback(q_lng* lng, OCIDefine *defnp, ub4 iter, void **bufpp,
          lng->str->terminate(lng->str->size() + lng->size);
          //printd(5, "q_long_callback() str: %p size: %d capacity: %d\n", lng->str, lng->str->size(), lng->str->capacity());
          if (*piecep == OCI_NEXT_PIECE) {
-            lng->str->reserve(lng->str->size() + Q_LONG_BLOCK_SIZE + 1);
-            lng->size = Q_LONG_BLOCK_SIZE;
+            lng->size = q_long_piece_size(lng->str->size());
+            lng->str->reserve(lng->str->size() + lng->size + 1);
             *bufpp = (void*)(lng->str->c_str() + lng->str->size());
          }
          break;
@@ -145,6 +155,45 @@ OraResultSet::OraResultSet(QoreOracleStatement &n_stmt, const char *str, Excepti
    }
 }
 
+QoreStringNode* OraColumnBuffer::takeString(ExceptionSink *xsink) {
+   assert(use_rlen);
+   char* nbuf = (char*)malloc(sizeof(char) * (maxsize + 1));
+   // redefine the column with the new buffer; the define handle is reused
+   if (stmt.defineByPos(defp, pos, nbuf, maxsize, SQLT_CHR, &ind, xsink, OCI_DEFAULT, &rlen)) {
+      free(nbuf);
+      return nullptr;
+   }
+
+   size_t len = rlen;
+   char* str = (char*)buf.ptr;
+   if (dtype == SQLT_AVC) {
+      while (len && str[len - 1] == ' ')
+         --len;
+   }
+   str[len] = '\0';
+   buf.ptr = nbuf;
+   return new QoreStringNode(str, len, maxsize + 1, stmt.getEncoding());
+}
+
+int OraColumnBuffer::getRawBufferSize() const {
+   return !maxsize || maxsize > ORA_RAW_SIZE ? ORA_RAW_SIZE : maxsize;
+}
+
+BinaryNode* OraColumnBuffer::takeBinary(ExceptionSink *xsink) {
+   assert(use_rlen);
+   int size = getRawBufferSize();
+   void* nbuf = malloc(size);
+   // redefine the column with the new buffer; the define handle is reused
+   if (stmt.defineByPos(defp, pos, nbuf, size, SQLT_BIN, &ind, xsink, OCI_DEFAULT, &rlen)) {
+      free(nbuf);
+      return nullptr;
+   }
+
+   BinaryNode* b = new BinaryNode(buf.ptr, rlen);
+   buf.ptr = nbuf;
+   return b;
+}
+
 int OraResultSet::define(const char *str, ExceptionSink *xsink) {
    //QORE_TRACE("OraResultSet::define()");
    //    printd(0, "OraResultSet::define()\n");
@@ -159,6 +208,7 @@ int OraResultSet::define(const char *str, ExceptionSink *xsink) {
    // iterate column list
    for (unsigned i = 0; i < clist.size(); ++i) {
       OraColumnBuffer *w = clist[i];
+      w->pos = i + 1;
       //printd(5, "OraResultSet::define() this=%p %s: w->dtype=%d\n", this, w->name.getBuffer(), w->dtype);
       switch (w->dtype) {
          case SQLT_INT:
@@ -221,31 +271,46 @@ int OraResultSet::define(const char *str, ExceptionSink *xsink) {
          // handle raw data
          case SQLT_BIN:
          case SQLT_LBI: {
-            int size = w->maxsize;
-            if (!size)
-               size = ORA_RAW_SIZE;
+            // RAW columns are defined with their described size
+            int size = w->getRawBufferSize();
 
-            w->buf.ptr = 0;
-            if (conn->rawResize((OCIRaw**)&w->buf.ptr, size, xsink))
-               return -1;
-
-            stmt.defineByPos(w->defp, i + 1, w->buf.ptr, size + sizeof(int), SQLT_LVB, &w->ind, xsink);
-            //printd(5, "OraResultSet::define() w=%p SQLT_LVB size=%d ptr=%p\n", w, size, w->buf.ptr);
+            w->buf.ptr = malloc(size);
+            w->use_rlen = true;
+            stmt.defineByPos(w->defp, i + 1, w->buf.ptr, size, SQLT_BIN, &w->ind, xsink, OCI_DEFAULT, &w->rlen);
+            //printd(5, "OraResultSet::define() w=%p SQLT_BIN size=%d ptr=%p\n", w, size, w->buf.ptr);
             break;
          }
 
          case SQLT_BLOB:
          case SQLT_CLOB:
+            if (conn->getLobAsLong() && conn->getLobMode() == OPT_LOB_VALUE) {
+               // fetch the LOB data with the row using a dynamic define like a LONG column
+               w->lob_long = true;
+               w->buf.lng = new q_lng(stmt.getEncoding(), w->dtype == SQLT_BLOB);
+               if (stmt.defineByPos(w->defp, i + 1, 0, SB4MAXVAL, w->dtype == SQLT_BLOB ? SQLT_LBI : SQLT_CHR, &w->ind,
+                                    xsink, OCI_DYNAMIC_FETCH))
+                  return -1;
+               stmt.defineDynamic(w->defp, w->buf.lng, (OCICallbackDefine)q_long_callback, xsink);
+               break;
+            }
             w->buf.ptr = 0;
             if (conn->descriptorAlloc(&w->buf.ptr, OCI_DTYPE_LOB, str, xsink))
                return -1;
             //printd(5, "OraResultSet::define() got LOB locator handle %p\n", w->buf.ptr);
-            stmt.defineByPos(w->defp, i + 1, &w->buf.ptr, 0, w->dtype, &w->ind, xsink);
+            if (stmt.defineByPos(w->defp, i + 1, &w->buf.ptr, 0, w->dtype, &w->ind, xsink))
+               return -1;
+            {
+               int rc = conn->setLobPrefetch(w->defp, xsink);
+               if (rc < 0)
+                  return -1;
+               w->lob_prefetch = rc > 0;
+            }
+            ++lob_cols;
             break;
 
          case SQLT_LNG:
             w->buf.lng = new q_lng(stmt.getEncoding());
-            if (stmt.defineByPos(w->defp, i + 1, 0, 1024 * 1024 * 10, SQLT_CHR, &w->ind, xsink, OCI_DYNAMIC_FETCH))
+            if (stmt.defineByPos(w->defp, i + 1, 0, conn->getLongMaxSize(), SQLT_CHR, &w->ind, xsink, OCI_DYNAMIC_FETCH))
                return -1;
 
             stmt.defineDynamic(w->defp, w->buf.lng, (OCICallbackDefine)q_long_callback, xsink);
@@ -316,7 +381,14 @@ int OraResultSet::define(const char *str, ExceptionSink *xsink) {
                w->maxsize = get_char_width(stmt.getEncoding(), w->charlen);
             w->buf.ptr = malloc(sizeof(char) * (w->maxsize + 1));
             //printd(0, "OraResultSet::define() i=%d, buf=%p, maxsize=%d\n", i + 1, w->buf.ptr, w->maxsize);
-            stmt.defineByPos(w->defp, i + 1, w->buf.ptr, w->maxsize + 1, SQLT_STR, &w->ind, xsink);
+            // use a return length if possible so that the value length is known without scanning the buffer
+            if (w->maxsize <= ORA_RLEN_MAX) {
+               w->use_rlen = true;
+               stmt.defineByPos(w->defp, i + 1, w->buf.ptr, w->maxsize, SQLT_CHR, &w->ind, xsink, OCI_DEFAULT,
+                                &w->rlen);
+            }
+            else
+               stmt.defineByPos(w->defp, i + 1, w->buf.ptr, w->maxsize + 1, SQLT_STR, &w->ind, xsink);
             break;
       }
       if (*xsink) return -1;
@@ -324,3 +396,193 @@ int OraResultSet::define(const char *str, ExceptionSink *xsink) {
 
    return 0;
 }
+
+#ifdef HAVE_OCILOBARRAYREAD
+// returns the length of the column's LOB value if it can be read together with other values, 0 if it has to be read
+// individually, or -1 if an exception was raised
+static int64 lob_array_len(QoreOracleConnection *conn, const QoreEncoding *enc, OraColumnBuffer *w,
+                           ExceptionSink *xsink) {
+   // the length can only be checked without a round trip if it was prefetched with the row
+   if ((w->dtype != SQLT_CLOB && w->dtype != SQLT_BLOB) || w->lob_long || w->ind == -1 || !w->lob_prefetch)
+      return 0;
+   oraub8 len;
+   if (conn->checkerr(OCILobGetLength2(conn->svchp, conn->errhp, (OCILobLocator*)w->buf.ptr, &len),
+      "OraResultSet::readLobs()", xsink))
+      return -1;
+   // empty values and values too large for a single read are read individually
+   if (!len || (w->dtype == SQLT_CLOB ? len * enc->getMaxCharWidth() : len) > LOB_ONE_PIECE_MAX)
+      return 0;
+#ifdef HAVE_OCILOBREAD2
+   // values prefetched with the row are read without a round trip
+   if (conn->isLobPrefetched(len))
+      return 0;
+#endif
+   return (int64)len;
+}
+
+// reads the values of the given LOB locators with one round trip; lens gives the lengths in bytes for BLOBs or in
+// characters for CLOBs
+static int lob_array_read(QoreOracleConnection *conn, const QoreEncoding *enc, std::vector<OCILobLocator*> &locs,
+                          const std::vector<oraub8> &lens, const std::vector<bool> &clobs, std::vector<QoreValue> &vals,
+                          ExceptionSink *xsink) {
+   ub4 iter = locs.size();
+   std::vector<oraub8> byte_amt(iter, 0);
+   std::vector<oraub8> char_amt(iter, 0);
+   std::vector<oraub8> offset(iter, 1);
+   std::vector<oraub8> bufl(iter);
+   std::vector<void*> bufs(iter);
+   vals.resize(iter);
+
+   // create the values and read the data directly into them
+   for (ub4 i = 0; i < iter; ++i) {
+      if (clobs[i]) {
+         QoreStringNode *str = new QoreStringNode(enc);
+         vals[i] = str;
+         bufl[i] = lens[i] * enc->getMaxCharWidth();
+         str->reserve(bufl[i]);
+         bufs[i] = (void*)str->getBuffer();
+         char_amt[i] = lens[i];
+      }
+      else {
+         BinaryNode *b = new BinaryNode;
+         vals[i] = b;
+         bufl[i] = lens[i];
+         b->preallocate(bufl[i]);
+         bufs[i] = (void*)b->getPtr();
+         byte_amt[i] = lens[i];
+      }
+   }
+
+   if (conn->checkerr(OCILobArrayRead(conn->svchp, conn->errhp, &iter, &locs[0], &byte_amt[0], &char_amt[0],
+      &offset[0], &bufs[0], &bufl[0], OCI_ONE_PIECE, nullptr, nullptr, conn->charsetid, SQLCS_IMPLICIT),
+      "OraResultSet::readLobs()", xsink)) {
+      for (auto &i : vals)
+         i.discard(xsink);
+      vals.clear();
+      return -1;
+   }
+
+   // set the sizes of the values read
+   for (ub4 i = 0; i < vals.size(); ++i) {
+      if (clobs[i])
+         vals[i].get<QoreStringNode>()->terminate(byte_amt[i]);
+      else
+         vals[i].get<BinaryNode>()->setSize(byte_amt[i]);
+   }
+   return 0;
+}
+#endif
+
+int OraResultSet::readLobs(ExceptionSink *xsink) {
+#ifdef HAVE_OCILOBARRAYREAD
+   QoreOracleConnection *conn = stmt.getData();
+   // locators returned as OracleLob objects are not read
+   if (lob_cols < 2 || conn->getLobMode() == OPT_LOB_LOCATOR)
+      return 0;
+
+   const QoreEncoding *enc = stmt.getEncoding();
+
+   // find the LOB values that can be read in one piece
+   std::vector<OraColumnBuffer*> cols;
+   std::vector<OCILobLocator*> locs;
+   std::vector<oraub8> lens;
+   std::vector<bool> clobs;
+   for (clist_t::iterator i = clist.begin(), e = clist.end(); i != e; ++i) {
+      OraColumnBuffer *w = *i;
+      int64 len = lob_array_len(conn, enc, w, xsink);
+      if (len < 0)
+         return -1;
+      if (!len)
+         continue;
+      cols.push_back(w);
+      locs.push_back((OCILobLocator*)w->buf.ptr);
+      lens.push_back(len);
+      clobs.push_back(w->dtype == SQLT_CLOB);
+   }
+
+   if (cols.size() < 2)
+      return 0;
+
+   std::vector<QoreValue> vals;
+   if (lob_array_read(conn, enc, locs, lens, clobs, vals, xsink))
+      return -1;
+   for (size_t i = 0; i < cols.size(); ++i)
+      cols[i]->lob_value = vals[i];
+#endif
+   return 0;
+}
+
+bool OraResultSet::canBatchLobs() const {
+#ifdef HAVE_OCILOBARRAYREAD
+   return lob_cols && stmt.getData()->getLobMode() == OPT_LOB_VALUE;
+#else
+   return false;
+#endif
+}
+
+int OraLobBatch::add(OraColumnBuffer *w, ExceptionSink *xsink) {
+#ifdef HAVE_OCILOBARRAYREAD
+   QoreOracleConnection *conn = stmt.getData();
+   int64 len = lob_array_len(conn, stmt.getEncoding(), w, xsink);
+   if (len <= 0)
+      return (int)len;
+
+   // copying a temporary LOB would need a round trip
+   boolean is_temp = FALSE;
+   if (conn->checkerr(OCILobIsTemporary(*conn->env, conn->errhp, (OCILobLocator*)w->buf.ptr, &is_temp),
+      "OraLobBatch::add()", xsink))
+      return -1;
+   if (is_temp)
+      return 0;
+
+   // the locator in the fetch buffer is overwritten by the next row
+   void *lobp = nullptr;
+   if (conn->descriptorAlloc(&lobp, OCI_DTYPE_LOB, "OraLobBatch::add()", xsink))
+      return -1;
+   if (conn->checkerr(OCILobLocatorAssign(conn->svchp, conn->errhp, (OCILobLocator*)w->buf.ptr,
+      (OCILobLocator**)&lobp), "OraLobBatch::add()", xsink)) {
+      QoreOracleConnection::descriptorFree(lobp, OCI_DTYPE_LOB);
+      return -1;
+   }
+   entries.push_back({(OCILobLocator*)lobp, (oraub8)len, w->dtype == SQLT_CLOB, nullptr, std::string()});
+   return 1;
+#else
+   return 0;
+#endif
+}
+
+int OraLobBatch::read(ExceptionSink *xsink) {
+#ifdef HAVE_OCILOBARRAYREAD
+   if (entries.empty())
+      return 0;
+
+   std::vector<OCILobLocator*> locs;
+   std::vector<oraub8> lens;
+   std::vector<bool> clobs;
+   for (auto &i : entries) {
+      assert(i.row);
+      locs.push_back(i.lobp);
+      lens.push_back(i.len);
+      clobs.push_back(i.clob);
+   }
+
+   std::vector<QoreValue> vals;
+   int rc = lob_array_read(stmt.getData(), stmt.getEncoding(), locs, lens, clobs, vals, xsink);
+   if (!rc) {
+      for (size_t i = 0; i < entries.size(); ++i) {
+         entries[i].row->setKeyValue(entries[i].key.c_str(), vals[i], xsink);
+      }
+   }
+   clear();
+   return rc || *xsink ? -1 : 0;
+#else
+   assert(entries.empty());
+   return 0;
+#endif
+}
+
+void OraLobBatch::clear() {
+   for (auto &i : entries)
+      QoreOracleConnection::descriptorFree(i.lobp, OCI_DTYPE_LOB);
+   entries.clear();
+}
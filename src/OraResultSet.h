@@ -32,6 +32,8 @@ public:
     OCIDefine *defp;     // define handle
     ub2 charlen;
     QoreString subdtypename;
+    unsigned pos = 0;    // column position
+    QoreValue lob_value; // LOB value already read with the other LOB values of the row
 
     DLLLOCAL OraColumnBuffer(QoreOracleStatement &stmt, const char *n, int len, int ms, ub2 dt, ub2 n_charlen, int subdt = SQLT_NTY_NONE, QoreString subdttn = "")
         : OraColumnValue(stmt, dt, subdt), name(n, len, stmt.getEncoding()), maxsize(ms), defp(0), charlen(n_charlen), subdtypename(subdttn) {
@@ -44,6 +46,8 @@ public:
 
     DLLLOCAL void del(ExceptionSink *xsink) {
         // printf("DLLLOCAL void del(Datasource *ds, ExceptionSink *xsink)\n");
+        lob_value.discard(xsink);
+        lob_value = QoreValue();
         if (defp) {
             OraColumnValue::del(xsink);
             OCIHandleFree(defp, OCI_HTYPE_DEFINE);
@@ -52,8 +56,37 @@ public:
     }
 
     DLLLOCAL QoreValue getValue(bool horizontal, ExceptionSink *xsink) {
-        return OraColumnValue::getValue(xsink, horizontal, false);
+        if (!lob_value.isNothing()) {
+            QoreValue rv = lob_value;
+            lob_value = QoreValue();
+            return rv;
+        }
+
+        // hand over the fetch buffer for string and binary values that fill at least half of it
+        if (use_rlen && ind != -1 && stmt.getData()->getZeroCopyStrings()) {
+            if (dtype == SQLT_BIN || dtype == SQLT_LBI) {
+                if ((rlen * 2) >= getRawBufferSize())
+                    return takeBinary(xsink);
+            } else if ((rlen * 2) >= maxsize)
+                return takeString(xsink);
+        }
+
+        QoreValue rv = OraColumnValue::getValue(xsink, horizontal, false);
+        // the nested cursor handle has been taken; allocate a new one for the next row
+        if (dtype == SQLT_RSET && !buf.ptr && !*xsink) {
+            stmt.getData()->handleAlloc(&buf.ptr, OCI_HTYPE_STMT, "OraColumnBuffer::getValue()", xsink);
+        }
+        return rv;
     }
+
+    // returns the fetch buffer as a string value and defines a new buffer for the column
+    DLLLOCAL QoreStringNode* takeString(ExceptionSink *xsink);
+
+    // returns the fetch buffer as a binary value and defines a new buffer for the column
+    DLLLOCAL BinaryNode* takeBinary(ExceptionSink *xsink);
+
+    // returns the size of the fetch buffer for RAW and LONG RAW columns; LONG RAW columns have no size
+    DLLLOCAL int getRawBufferSize() const;
 };
 
 typedef std::vector<OraColumnBuffer *> clist_t;
@@ -62,6 +95,8 @@ class OraResultSet {
 protected:
     QoreOracleStatement &stmt;
     bool defined;
+    // the number of LOB columns defined with locators
+    unsigned lob_cols = 0;
 
 public:
     clist_t clist;
@@ -79,6 +114,7 @@ public:
         }
         clist.clear();
         defined = false;
+        lob_cols = 0;
     }
 
     DLLLOCAL void add(const char *name, int nlen, int maxsize, ub2 dtype, ub2 char_len, int subtype=SQLT_NTY_NONE, QoreString subdtn = "") {
@@ -94,6 +130,58 @@ public:
     }
 
     DLLLOCAL int define(const char *str, ExceptionSink *xsink);
+
+    // reads the values of all LOB columns of the current row in one round trip if there are several
+    DLLLOCAL int readLobs(ExceptionSink *xsink);
+
+    // returns true if LOB values of several rows can be read together with an OraLobBatch
+    DLLLOCAL bool canBatchLobs() const;
+};
+
+// LOB values of several rows read with one OCILobArrayRead() call
+class OraLobBatch {
+public:
+    DLLLOCAL OraLobBatch(QoreOracleStatement &stmt) : stmt(stmt) {
+    }
+
+    DLLLOCAL ~OraLobBatch() {
+        clear();
+    }
+
+    // adds a copy of the column's LOB locator if the value can be read with the batch; setTarget() must be called
+    // for the value afterwards
+    // returns 1 if added, 0 if the value has to be read individually, -1 if an exception was raised
+    DLLLOCAL int add(OraColumnBuffer *w, ExceptionSink *xsink);
+
+    // sets the row and key to which the value added last is assigned when it is read
+    DLLLOCAL void setTarget(QoreHashNode *row, const char *key) {
+        assert(!entries.empty());
+        entries.back().row = row;
+        entries.back().key = key;
+    }
+
+    // reads all values added and assigns them to their rows
+    DLLLOCAL int read(ExceptionSink *xsink);
+
+    DLLLOCAL size_t size() const {
+        return entries.size();
+    }
+
+private:
+    struct OraLobBatchEntry {
+        OCILobLocator *lobp;
+        // the length in bytes (BLOB) or characters (CLOB)
+        oraub8 len;
+        bool clob;
+        QoreHashNode *row;
+        std::string key;
+    };
+
+    QoreOracleStatement &stmt;
+    std::vector<OraLobBatchEntry> entries;
+
+    // frees the locator copies
+    DLLLOCAL void clear();
 };
 
 class OraResultSetHelper {
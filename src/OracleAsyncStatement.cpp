@@ -0,0 +1,370 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  OracleAsyncStatement.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, sro
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "OracleAsyncStatementPriv.h"
+
+QoreOracleAsyncPool oraAsyncPool;
+
+int QoreOracleAsyncPool::queue(OracleAsyncStatementPriv* as, ExceptionSink* xsink) {
+    AutoLocker al(l);
+    if (quit) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "the completion thread pool has been stopped");
+        return -1;
+    }
+
+    // start a thread if all threads are busy and the maximum has not been reached; otherwise the call waits for a
+    // thread to become idle
+    if (calls.size() >= idle && threads.size() < max_threads) {
+        pthread_t thread;
+        int rc;
+        if ((rc = pthread_create(&thread, NULL, &QoreOracleAsyncPool::thread_helper, this))) {
+            if (threads.empty()) {
+                xsink->raiseErrnoException("THREAD-CREATION-FAILURE", rc, "could not create a completion thread "
+                    "for asynchronous calls");
+                return -1;
+            }
+        } else {
+            threads.push_back(thread);
+        }
+    }
+
+    as->ref();
+    calls.push_back(as);
+    cond.signal();
+    return 0;
+}
+
+void QoreOracleAsyncPool::shutdown() {
+    thread_list_t tl;
+    call_list_t cl;
+    {
+        AutoLocker al(l);
+        quit = true;
+        cond.broadcast();
+        tl.swap(threads);
+        cl.swap(calls);
+    }
+    for (thread_list_t::iterator i = tl.begin(), e = tl.end(); i != e; ++i)
+        pthread_join(*i, 0);
+
+    ExceptionSink xsink;
+    for (call_list_t::iterator i = cl.begin(), e = cl.end(); i != e; ++i)
+        (*i)->deref(&xsink);
+}
+
+void QoreOracleAsyncPool::run() {
+    // the pool threads are registered with Qore, as the calls create Qore values
+    QoreForeignThreadHelper qfth;
+
+    AutoLocker al(l);
+    while (true) {
+        ++idle;
+        while (calls.empty() && !quit)
+            cond.wait(l);
+        --idle;
+        if (quit)
+            break;
+
+        OracleAsyncStatementPriv* as = calls.front();
+        calls.pop_front();
+
+        AutoUnlocker au(&l);
+        as->run();
+        ExceptionSink xsink;
+        as->deref(&xsink);
+    }
+}
+
+int OracleAsyncStatementPriv::open(const QoreHashNode* opts, ExceptionSink* xsink) {
+    assert(!ds && !dsobj);
+    ds = oracle_open_datasource(opts, ORACLEASYNCSTATEMENT_ERROR, xsink);
+    if (!ds)
+        return -1;
+
+    // calls are interrupted through the call monitor with a cancel key unique to this object
+    SimpleRefHolder<QoreStringNode> key(new QoreStringNodeMaker("oracle-async-%p", this));
+    if (ds->setOption(ORA_OPT_CANCEL_KEY, *key, xsink)) {
+        ds->close();
+        delete ds;
+        ds = nullptr;
+        return -1;
+    }
+    cancel_key = key->c_str();
+    return 0;
+}
+
+int OracleAsyncStatementPriv::setDatasource(QoreObject* obj, ExceptionSink* xsink) {
+    assert(!ds && !dsobj);
+    const QoreClass* qc = getProgram()->findClass("Qore::SQL::AbstractDatasource", xsink);
+    if (!qc) {
+        if (!*xsink)
+            xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "the AbstractDatasource class is not available in the "
+                "current program");
+        return -1;
+    }
+    if (!obj->validInstanceOf(*qc)) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "expecting a Datasource or DatasourcePool object; got an "
+            "object of class '%s' instead", obj->getClassName());
+        return -1;
+    }
+    obj->ref();
+    dsobj = obj;
+    return 0;
+}
+
+int OracleAsyncStatementPriv::checkIdleUnlocked(const char* m, ExceptionSink* xsink) {
+    if (!ds && !dsobj) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "cannot execute OracleAsyncStatement::%s(); the connection "
+            "has already been closed", m);
+        return -1;
+    }
+    if (busy) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "cannot execute OracleAsyncStatement::%s() while a call "
+            "is in progress; wait for the call to complete with OracleAsyncStatement::getResult() first", m);
+        return -1;
+    }
+    return 0;
+}
+
+void OracleAsyncStatementPriv::clearResultUnlocked(ExceptionSink* xsink) {
+    result.discard(xsink);
+    result = QoreValue();
+    call_xsink.clear();
+    have_result = false;
+}
+
+int OracleAsyncStatementPriv::start(call_type_e t, const QoreStringNode* q, const QoreListNode* a,
+        ExceptionSink* xsink) {
+    AutoLocker al(l);
+    if (checkIdleUnlocked("start", xsink))
+        return -1;
+
+    // a result that was not retrieved is discarded
+    clearResultUnlocked(xsink);
+
+    if (oraAsyncPool.queue(this, xsink))
+        return -1;
+
+    type = t;
+    sql = q->stringRefSelf();
+    args = a ? a->listRefSelf() : nullptr;
+    // the call is made in the context of the calling thread's program
+    pgm = getProgram();
+    pending = busy = true;
+    return 0;
+}
+
+bool OracleAsyncStatementPriv::wait(int64 timeout_ms) {
+    AutoLocker al(l);
+    if (timeout_ms < 0) {
+        while (busy)
+            done_cond.wait(l);
+        return true;
+    }
+
+    int64 deadline = q_clock_getmillis() + timeout_ms;
+    while (busy) {
+        int64 now = q_clock_getmillis();
+        if (now >= deadline)
+            return false;
+        done_cond.wait(l, (int)(deadline - now));
+    }
+    return true;
+}
+
+QoreValue OracleAsyncStatementPriv::getResult(int64 timeout_ms, ExceptionSink* xsink) {
+    if (!wait(timeout_ms)) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "the call did not complete within " QLLD "ms", timeout_ms);
+        return QoreValue();
+    }
+
+    AutoLocker al(l);
+    if (!have_result) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "no result is available; no call has been started or the "
+            "result has already been retrieved");
+        return QoreValue();
+    }
+    have_result = false;
+
+    if (call_xsink) {
+        xsink->assimilate(call_xsink);
+        return QoreValue();
+    }
+
+    QoreValue rv = result;
+    result = QoreValue();
+    return rv;
+}
+
+bool OracleAsyncStatementPriv::cancel(ExceptionSink* xsink) {
+    AutoLocker al(l);
+    if (!busy)
+        return false;
+
+    if (pending) {
+        // the call has not been taken by a pool thread yet; the pool thread drops it
+        pending = busy = false;
+        sql->deref();
+        sql = nullptr;
+        if (args) {
+            args->deref(xsink);
+            args = nullptr;
+        }
+        call_xsink.raiseException("DBI:ORACLE:CALL-CANCELLED", "the call was cancelled before it was started");
+        have_result = true;
+        done_cond.broadcast();
+        return true;
+    }
+
+    // calls on a datasource object cannot be interrupted, as its connections are not assigned a cancel key
+    if (cancel_key.empty())
+        return false;
+    return oraCallMonitor.cancel(cancel_key.c_str()) > 0;
+}
+
+int OracleAsyncStatementPriv::commit(ExceptionSink* xsink) {
+    AutoLocker al(l);
+    if (checkIdleUnlocked("commit", xsink))
+        return -1;
+    if (dsobj) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "cannot execute OracleAsyncStatement::commit() with a "
+            "datasource object; each call is committed when it completes");
+        return -1;
+    }
+    return ds->commit(xsink);
+}
+
+int OracleAsyncStatementPriv::rollback(ExceptionSink* xsink) {
+    AutoLocker al(l);
+    if (checkIdleUnlocked("rollback", xsink))
+        return -1;
+    if (dsobj) {
+        xsink->raiseException(ORACLEASYNCSTATEMENT_ERROR, "cannot execute OracleAsyncStatement::rollback() with a "
+            "datasource object; each call is committed when it completes or rolled back when it fails");
+        return -1;
+    }
+    return ds->rollback(xsink);
+}
+
+void OracleAsyncStatementPriv::close(ExceptionSink* xsink) {
+    {
+        AutoLocker al(l);
+        if (!ds && !dsobj)
+            return;
+    }
+
+    // interrupt any call in progress and wait for it to complete
+    cancel(xsink);
+    wait(-1);
+
+    {
+        AutoLocker al(l);
+        clearResultUnlocked(xsink);
+    }
+
+    if (dsobj) {
+        dsobj->deref(xsink);
+        dsobj = nullptr;
+        return;
+    }
+
+    // the connection would commit any open transaction when it's closed
+    if (ds->isInTransaction())
+        ds->rollback(xsink);
+    ds->close();
+    delete ds;
+    ds = nullptr;
+}
+
+QoreValue OracleAsyncStatementPriv::callDatasource(call_type_e t, const QoreStringNode* q, const QoreListNode* a,
+        ExceptionSink* xsink) {
+    const char* m = t == ASYNC_EXEC ? "exec" : (t == ASYNC_SELECT ? "select" : "selectRows");
+
+    ReferenceHolder<QoreListNode> margs(new QoreListNode, xsink);
+    margs->push(q->stringRefSelf(), xsink);
+    if (a) {
+        ConstListIterator li(a);
+        while (li.next())
+            margs->push(li.getValue().refSelf(), xsink);
+    }
+
+    ValueHolder rv(dsobj->evalMethod(m, *margs, xsink), xsink);
+
+    // the transaction is finished in this thread, as the datasource assigns it to the thread that started it
+    ExceptionSink txsink;
+    if (dsobj->evalMethod("inTransaction", nullptr, &txsink).getAsBool())
+        dsobj->evalMethod(*xsink ? "rollback" : "commit", nullptr, &txsink);
+    xsink->assimilate(txsink);
+
+    return *xsink ? QoreValue() : rv.release();
+}
+
+void OracleAsyncStatementPriv::run() {
+    AutoLocker al(l);
+    // the call was cancelled before it was taken
+    if (!pending)
+        return;
+
+    pending = false;
+    call_type_e t = type;
+    SimpleRefHolder<QoreStringNode> q(sql);
+    sql = nullptr;
+    QoreListNode* a = args;
+    args = nullptr;
+
+    ExceptionSink xsink;
+    ValueHolder rv(&xsink);
+    {
+        // the lock is released during the call so that it can be cancelled
+        AutoUnlocker au(&l);
+        QoreExternalProgramContextHelper pch(&xsink, pgm);
+        if (!xsink) {
+            if (dsobj) {
+                rv = callDatasource(t, *q, a, &xsink);
+            } else {
+                switch (t) {
+                    case ASYNC_EXEC:
+                        rv = ds->exec(*q, a, &xsink);
+                        break;
+                    case ASYNC_SELECT:
+                        rv = ds->select(*q, a, &xsink);
+                        break;
+                    case ASYNC_SELECT_ROWS:
+                        rv = ds->selectRows(*q, a, &xsink);
+                        break;
+                }
+            }
+        }
+        if (a)
+            a->deref(&xsink);
+    }
+
+    if (xsink)
+        call_xsink.assimilate(xsink);
+    else
+        result = rv.release();
+    busy = false;
+    have_result = true;
+    done_cond.broadcast();
+}
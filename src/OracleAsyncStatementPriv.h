@@ -0,0 +1,204 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  OracleAsyncStatementPriv.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, sro
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef ORACLEASYNCSTATEMENTPRIV_H
+#define ORACLEASYNCSTATEMENTPRIV_H
+
+#include <qore/Qore.h>
+#include "oracle.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+DLLLOCAL extern qore_classid_t CID_ORACLEASYNCSTATEMENT;
+DLLLOCAL extern QoreClass* QC_ORACLEASYNCSTATEMENT;
+
+#define ORACLEASYNCSTATEMENT_ERROR "ORACLEASYNCSTATEMENT-ERROR"
+
+// the default maximum number of completion threads
+#define ORA_ASYNC_THREADS_DEFAULT 8
+
+class OracleAsyncStatementPriv;
+
+//! a bounded pool of completion threads shared by all OracleAsyncStatement objects
+/** a thread is started when a call is queued and no thread is idle, up to the maximum number of threads; further
+    calls wait in the queue for a thread to become idle; threads are kept until the module is deleted
+*/
+class QoreOracleAsyncPool {
+public:
+    DLLLOCAL QoreOracleAsyncPool() {
+    }
+
+    DLLLOCAL ~QoreOracleAsyncPool() {
+        assert(calls.empty());
+        assert(threads.empty());
+    }
+
+    //! queues the pending call of the object; the object is referenced until a pool thread has taken the call
+    DLLLOCAL int queue(OracleAsyncStatementPriv* as, ExceptionSink* xsink);
+
+    //! sets the maximum number of threads; threads already started are kept
+    DLLLOCAL void setMaxThreads(unsigned max) {
+        AutoLocker al(l);
+        max_threads = max;
+    }
+
+    DLLLOCAL unsigned getMaxThreads() {
+        AutoLocker al(l);
+        return max_threads;
+    }
+
+    //! stops all pool threads; called when the module is deleted
+    DLLLOCAL void shutdown();
+
+private:
+    typedef std::deque<OracleAsyncStatementPriv*> call_list_t;
+    typedef std::vector<pthread_t> thread_list_t;
+
+    QoreThreadLock l;
+    //! signaled when a call is queued
+    QoreCondition cond;
+    //! objects with a call waiting for a thread
+    call_list_t calls;
+    thread_list_t threads;
+    unsigned max_threads = ORA_ASYNC_THREADS_DEFAULT,
+        //! the number of threads waiting for a call
+        idle = 0;
+    bool quit = false;
+
+    DLLLOCAL void run();
+
+    DLLLOCAL static void* thread_helper(void* context) {
+        ((QoreOracleAsyncPool*)context)->run();
+        return 0;
+    }
+};
+
+DLLLOCAL extern QoreOracleAsyncPool oraAsyncPool;
+
+//! executes SQL calls in the shared completion thread pool, so that the calling thread is not blocked
+/** calls are made either on a dedicated connection or on a Datasource or DatasourcePool object
+*/
+class OracleAsyncStatementPriv : public AbstractPrivateData {
+public:
+    //! the Datasource method used for the call
+    enum call_type_e {
+        ASYNC_EXEC,
+        ASYNC_SELECT,
+        ASYNC_SELECT_ROWS,
+    };
+
+    DLLLOCAL OracleAsyncStatementPriv() {
+    }
+
+    //! opens the dedicated connection
+    DLLLOCAL int open(const QoreHashNode* opts, ExceptionSink* xsink);
+
+    //! uses the given Datasource or DatasourcePool object for calls; the object is referenced
+    DLLLOCAL int setDatasource(QoreObject* obj, ExceptionSink* xsink);
+
+    //! queues the call in the completion thread pool and returns immediately
+    DLLLOCAL int start(call_type_e type, const QoreStringNode* sql, const QoreListNode* args, ExceptionSink* xsink);
+
+    //! waits for the current call to complete; timeout_ms < 0 = wait forever; returns true if no call is in progress
+    DLLLOCAL bool wait(int64 timeout_ms);
+
+    //! returns true if no call is in progress
+    DLLLOCAL bool isDone() {
+        AutoLocker al(l);
+        return !busy;
+    }
+
+    //! waits for the call to complete and returns its result or raises its exception
+    DLLLOCAL QoreValue getResult(int64 timeout_ms, ExceptionSink* xsink);
+
+    //! interrupts the call in progress; returns true if a call was interrupted
+    DLLLOCAL bool cancel(ExceptionSink* xsink);
+
+    DLLLOCAL int commit(ExceptionSink* xsink);
+
+    DLLLOCAL int rollback(ExceptionSink* xsink);
+
+    //! cancels any call in progress and closes the dedicated connection or releases the datasource object
+    DLLLOCAL void close(ExceptionSink* xsink);
+
+    //! makes the pending call; called in a pool thread
+    DLLLOCAL void run();
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            close(xsink);
+            delete this;
+        }
+    }
+
+protected:
+    DLLLOCAL virtual ~OracleAsyncStatementPriv() {
+        assert(!ds);
+        assert(!dsobj);
+        assert(!sql);
+        assert(!args);
+    }
+
+private:
+    QoreThreadLock l;
+    //! signals waiting threads that a call has completed
+    QoreCondition done_cond;
+    //! the dedicated connection
+    Datasource* ds = nullptr;
+    //! the Datasource or DatasourcePool object used instead of a dedicated connection
+    QoreObject* dsobj = nullptr;
+    //! the key for cancelling calls on the dedicated connection
+    std::string cancel_key;
+    //! the pending call
+    call_type_e type = ASYNC_EXEC;
+    QoreStringNode* sql = nullptr;
+    QoreListNode* args = nullptr;
+    //! the program of the thread that started the call
+    QoreProgram* pgm = nullptr;
+    //! the result of the last call
+    QoreValue result;
+    //! the exception raised by the last call
+    ExceptionSink call_xsink;
+    //! true if a call has been started and not yet taken by a pool thread
+    bool pending = false,
+        //! true if a call is pending or in progress
+        busy = false,
+        //! true if the result of the last call has not been retrieved
+        have_result = false;
+
+    //! discards the result of the last call; must be called with the lock held
+    DLLLOCAL void clearResultUnlocked(ExceptionSink* xsink);
+
+    //! raises an exception if the connection is closed or a call is in progress; must be called with the lock held
+    DLLLOCAL int checkIdleUnlocked(const char* m, ExceptionSink* xsink);
+
+    //! makes the call with the Datasource or DatasourcePool object
+    DLLLOCAL QoreValue callDatasource(call_type_e t, const QoreStringNode* q, const QoreListNode* a,
+            ExceptionSink* xsink);
+};
+
+#endif
@@ -0,0 +1,284 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  OracleLobStream.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, sro
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "OracleLobStreamPriv.h"
+
+// returns the length of the data up to the end of the last complete UTF-8 character
+static size_t utf8_complete_len(const char* p, size_t len) {
+    // check the start of the last character, which can be at most 3 bytes before the end
+    size_t i = len;
+    for (unsigned n = 1; n <= 4 && i; ++n) {
+        unsigned char c = (unsigned char)p[--i];
+        // continuation byte
+        if ((c & 0xc0) == 0x80)
+            continue;
+        unsigned clen = c < 0x80 ? 1 : ((c & 0xe0) == 0xc0 ? 2 : ((c & 0xf0) == 0xe0 ? 3 : 4));
+        return clen > n ? i : len;
+    }
+    return len;
+}
+
+QoreThreadLock OracleLobPriv::registry_lock;
+
+OracleLobPriv::OracleLobPriv(QoreOracleConnection* conn, OCILobLocator* lobp, bool clob, const QoreEncoding* enc)
+        : conn(conn), lobp(lobp), enc(enc), clob(clob) {
+    AutoLocker al(registry_lock);
+    conn->registerLob(this);
+}
+
+OracleLobPriv::~OracleLobPriv() {
+    AutoLocker al(registry_lock);
+    if (conn) {
+        conn->deregisterLob(this);
+        invalidate();
+    }
+}
+
+void OracleLobPriv::invalidate() {
+    QoreOracleConnection::descriptorFree(lobp, OCI_DTYPE_LOB);
+    lobp = nullptr;
+    conn = nullptr;
+}
+
+QoreOracleConnection* OracleLobPriv::getConnection(const char* err, ExceptionSink* xsink) {
+    // LOBs are used in the thread holding the connection, which is also the only thread that can close it
+    if (!conn) {
+        xsink->raiseException(err, "the LOB cannot be used because the connection that returned it has been closed");
+        return nullptr;
+    }
+    conn->quiesce();
+    return conn;
+}
+
+int64 OracleLobPriv::getLength(const char* err, ExceptionSink* xsink) {
+    QoreOracleConnection* c = getConnection(err, xsink);
+    if (!c)
+        return -1;
+    QoreOracleServerCallHelper sch(*c, xsink);
+    if (sch.check())
+        return -1;
+    oraub8 len;
+    if (c->checkerr(OCILobGetLength2(c->svchp, c->errhp, lobp, &len), "OracleLob::getLength()", xsink))
+        return -1;
+    return (int64)len;
+}
+
+QoreValue oracle_get_lob_object(QoreOracleConnection* conn, OCILobLocator* src, bool clob, const QoreEncoding* enc,
+        ExceptionSink* xsink) {
+    // the locator in the fetch or bind buffer is reused, so the object gets a copy
+    OCILobLocator* lobp;
+    if (conn->descriptorAlloc((void**)&lobp, OCI_DTYPE_LOB, "oracle_get_lob_object()", xsink))
+        return QoreValue();
+    if (conn->checkerr(OCILobLocatorAssign(conn->svchp, conn->errhp, src, &lobp), "oracle_get_lob_object()",
+        xsink)) {
+        QoreOracleConnection::descriptorFree(lobp, OCI_DTYPE_LOB);
+        return QoreValue();
+    }
+    return new QoreObject(QC_ORACLELOB, getProgram(), new OracleLobPriv(conn, lobp, clob, enc));
+}
+
+int OracleLobStream::open(OracleLobPriv* l, bool write, ExceptionSink* xsink) {
+    assert(!lob);
+    ReferenceHolder<OracleLobPriv> holder(l, xsink);
+
+    QoreOracleConnection* conn = l->getConnection(err, xsink);
+    if (!conn)
+        return -1;
+    QoreOracleServerCallHelper sch(*conn, xsink);
+    if (sch.check())
+        return -1;
+
+    // get the length to detect the end of the data when reading
+    if (conn->checkerr(OCILobGetLength2(conn->svchp, conn->errhp, l->getLocator(), &length),
+        "OracleLobStream::open()", xsink))
+        return -1;
+
+    if (write) {
+        // open the LOB so that indexes and triggers are processed once when it is closed and not for every write
+        if (conn->checkerr(OCILobOpen(conn->svchp, conn->errhp, l->getLocator(), OCI_LOB_READWRITE),
+            "OracleLobStream::open()", xsink))
+            return -1;
+        lob_open = true;
+    }
+
+    clob = l->isClob();
+    enc = l->getEncoding();
+    lob = holder.release();
+    return 0;
+}
+
+int OracleLobStream::close(ExceptionSink* xsink) {
+    if (!lob)
+        return 0;
+
+    int rc = 0;
+    if (!pending.empty()) {
+        xsink->raiseException(err, "cannot close the CLOB stream; the last %d byte%s written do not form a "
+            "complete character", (int)pending.size(), pending.size() == 1 ? "" : "s");
+        rc = -1;
+    }
+    pending.clear();
+
+    if (lob_open) {
+        lob_open = false;
+        // if the connection has been closed, the LOB was closed with it
+        QoreOracleConnection* conn = lob->getConnection(err, xsink);
+        if (!conn) {
+            rc = -1;
+        } else {
+            QoreOracleServerCallHelper sch(*conn, xsink);
+            if (sch.check()) {
+                rc = -1;
+            } else {
+                // remove any data left over from a longer previous value
+                if (!rc && offset - 1 < length && conn->checkerr(OCILobTrim2(conn->svchp, conn->errhp,
+                    lob->getLocator(), offset - 1), "OracleLobStream::close()", xsink))
+                    rc = -1;
+                // the LOB must be closed before the transaction is committed
+                if (conn->checkerr(OCILobClose(conn->svchp, conn->errhp, lob->getLocator()),
+                    "OracleLobStream::close()", xsink))
+                    rc = -1;
+            }
+        }
+    }
+
+    lob->deref(xsink);
+    lob = nullptr;
+    return rc;
+}
+
+QoreOracleConnection* OracleLobStream::getConnection(ExceptionSink* xsink) {
+    if (!lob) {
+        xsink->raiseException(err, "the LOB stream has already been closed");
+        return nullptr;
+    }
+    return lob->getConnection(err, xsink);
+}
+
+int64 OracleLobStream::readIntern(QoreOracleConnection* conn, char* ptr, int64 limit, ExceptionSink* xsink) {
+    if (offset > length)
+        return 0;
+
+    QoreOracleServerCallHelper sch(*conn, xsink);
+    if (sch.check())
+        return -1;
+
+    // the amount is given in bytes; for CLOBs only complete characters are returned
+    oraub8 byte_amt = limit;
+    oraub8 char_amt = 0;
+    if (conn->checkerr(OCILobRead2(conn->svchp, conn->errhp, lob->getLocator(), &byte_amt, &char_amt, offset, ptr, limit,
+        OCI_ONE_PIECE, 0, 0, clob ? conn->charsetid : 0, SQLCS_IMPLICIT), "OracleLobStream::read()", xsink))
+        return -1;
+    offset += clob ? char_amt : byte_amt;
+    return byte_amt;
+}
+
+int64 OracleLobStream::read(void* ptr, int64 limit, ExceptionSink* xsink) {
+    QoreOracleConnection* conn = getConnection(xsink);
+    if (!conn)
+        return -1;
+
+    if (!pending.empty()) {
+        size_t len = (size_t)limit < pending.size() ? (size_t)limit : pending.size();
+        memcpy(ptr, pending.data(), len);
+        pending.erase(0, len);
+        return len;
+    }
+
+    if (clob) {
+        // make sure that there is room for at least one character
+        unsigned width = getEncoding()->getMaxCharWidth();
+        if (limit < width) {
+            char buf[8];
+            int64 len = readIntern(conn, buf, width, xsink);
+            if (len <= 0)
+                return len;
+            pending.assign(buf, len);
+            return read(ptr, limit, xsink);
+        }
+    }
+
+    return readIntern(conn, (char*)ptr, limit, xsink);
+}
+
+int64 OracleLobStream::peek(ExceptionSink* xsink) {
+    QoreOracleConnection* conn = getConnection(xsink);
+    if (!conn)
+        return -1;
+
+    if (pending.empty()) {
+        pending.resize(LOB_BLOCK_SIZE);
+        int64 len = readIntern(conn, &pending[0], LOB_BLOCK_SIZE, xsink);
+        pending.resize(len > 0 ? len : 0);
+        if (len <= 0)
+            return -1;
+    }
+    return (unsigned char)pending[0];
+}
+
+int OracleLobStream::writeIntern(QoreOracleConnection* conn, const char* ptr, size_t len, ExceptionSink* xsink) {
+    QoreOracleServerCallHelper sch(*conn, xsink);
+    if (sch.check())
+        return -1;
+
+    oraub8 byte_amt = len;
+    oraub8 char_amt = 0;
+    if (conn->checkerr(OCILobWrite2(conn->svchp, conn->errhp, lob->getLocator(), &byte_amt, &char_amt, offset, (void*)ptr, len,
+        OCI_ONE_PIECE, 0, 0, clob ? conn->charsetid : 0, SQLCS_IMPLICIT), "OracleLobStream::write()", xsink))
+        return -1;
+    offset += clob ? char_amt : byte_amt;
+    return 0;
+}
+
+int OracleLobStream::write(const void* ptr, int64 count, ExceptionSink* xsink) {
+    QoreOracleConnection* conn = getConnection(xsink);
+    if (!conn)
+        return -1;
+    if (!count)
+        return 0;
+
+    const char* p = (const char*)ptr;
+    size_t len = count;
+
+    // CLOB data can only be written in complete characters; a character split over two writes is kept until the
+    // next write
+    std::string buf;
+    if (clob && getEncoding() == QCS_UTF8) {
+        if (!pending.empty()) {
+            buf = pending;
+            buf.append(p, len);
+            pending.clear();
+            p = buf.data();
+            len = buf.size();
+        }
+        size_t complete = utf8_complete_len(p, len);
+        if (complete < len) {
+            pending.assign(p + complete, len - complete);
+            len = complete;
+        }
+        if (!len)
+            return 0;
+    }
+
+    return writeIntern(conn, p, len, xsink);
+}
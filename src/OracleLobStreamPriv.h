@@ -0,0 +1,231 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  OracleLobStreamPriv.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, sro
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef ORACLELOBSTREAMPRIV_H
+#define ORACLELOBSTREAMPRIV_H
+
+#include <qore/Qore.h>
+#include <qore/InputStream.h>
+#include <qore/OutputStream.h>
+#include "oracle.h"
+
+#include <string>
+
+DLLLOCAL extern qore_classid_t CID_ORACLELOB;
+DLLLOCAL extern QoreClass* QC_ORACLELOB;
+DLLLOCAL extern qore_classid_t CID_ORACLELOBINPUTSTREAM;
+DLLLOCAL extern QoreClass* QC_ORACLELOBINPUTSTREAM;
+DLLLOCAL extern qore_classid_t CID_ORACLELOBOUTPUTSTREAM;
+DLLLOCAL extern QoreClass* QC_ORACLELOBOUTPUTSTREAM;
+
+//! a copy of a LOB locator returned by the driver on the connection of the datasource that returned it
+/** the locator is freed when the connection is closed or reconnected; afterwards the object cannot be used
+*/
+class OracleLobPriv : public AbstractPrivateData {
+public:
+    //! protects the connection pointers and the LOB registries of all connections
+    DLLLOCAL static QoreThreadLock registry_lock;
+
+    //! takes ownership of the locator and registers the object with the connection
+    DLLLOCAL OracleLobPriv(QoreOracleConnection* conn, OCILobLocator* lobp, bool clob, const QoreEncoding* enc);
+
+    //! returns the connection or raises an exception if the connection has been closed
+    DLLLOCAL QoreOracleConnection* getConnection(const char* err, ExceptionSink* xsink);
+
+    //! returns the length of the LOB in bytes (BLOB) or characters (CLOB) or -1 if an exception was raised
+    DLLLOCAL int64 getLength(const char* err, ExceptionSink* xsink);
+
+    //! frees the locator; called by the connection with the registry lock held before the session is closed
+    DLLLOCAL void invalidate();
+
+    DLLLOCAL OCILobLocator* getLocator() const {
+        return lobp;
+    }
+
+    DLLLOCAL bool isClob() const {
+        return clob;
+    }
+
+    DLLLOCAL const QoreEncoding* getEncoding() const {
+        return enc;
+    }
+
+protected:
+    DLLLOCAL virtual ~OracleLobPriv();
+
+private:
+    QoreOracleConnection* conn;
+    OCILobLocator* lobp;
+    const QoreEncoding* enc;
+    bool clob;
+};
+
+//! a LOB read or written sequentially on the connection of the datasource that returned it
+class OracleLobStream {
+public:
+    DLLLOCAL OracleLobStream(const char* err) : err(err) {
+    }
+
+    DLLLOCAL ~OracleLobStream() {
+        assert(!lob);
+    }
+
+    //! opens the stream on the LOB; writing starts at the beginning of the LOB
+    DLLLOCAL int open(OracleLobPriv* lob, bool write, ExceptionSink* xsink);
+
+    //! finishes writing and closes the stream; changes are not committed
+    DLLLOCAL int close(ExceptionSink* xsink);
+
+    //! reads up to limit bytes into the given buffer and returns the number of bytes read; 0 = end of data
+    DLLLOCAL int64 read(void* ptr, int64 limit, ExceptionSink* xsink);
+
+    //! returns the next byte without consuming it or -1 at the end of the data
+    DLLLOCAL int64 peek(ExceptionSink* xsink);
+
+    //! appends data at the current position
+    DLLLOCAL int write(const void* ptr, int64 count, ExceptionSink* xsink);
+
+    DLLLOCAL bool isOpen() const {
+        return (bool)lob;
+    }
+
+    DLLLOCAL bool isClob() const {
+        return clob;
+    }
+
+    //! returns the length of the LOB in bytes (BLOB) or characters (CLOB) when it was opened
+    DLLLOCAL int64 getLength() const {
+        return length;
+    }
+
+    //! returns the character encoding of CLOB data
+    DLLLOCAL const QoreEncoding* getEncoding() const {
+        return enc;
+    }
+
+private:
+    OracleLobPriv* lob = nullptr;
+    //! the exception code for errors
+    const char* err;
+    const QoreEncoding* enc = QCS_DEFAULT;
+    //! the length of the LOB in bytes (BLOB) or characters (CLOB)
+    oraub8 length = 0;
+    //! the current 1-based offset in bytes (BLOB) or characters (CLOB)
+    oraub8 offset = 1;
+    //! data read but not yet returned, or an incomplete character not yet written
+    std::string pending;
+    bool clob = false;
+    //! true if the LOB was opened for writing with OCILobOpen()
+    bool lob_open = false;
+
+    //! returns the connection of the LOB for the next call or raises an exception if it cannot be used
+    DLLLOCAL QoreOracleConnection* getConnection(ExceptionSink* xsink);
+
+    DLLLOCAL int64 readIntern(QoreOracleConnection* conn, char* ptr, int64 limit, ExceptionSink* xsink);
+
+    DLLLOCAL int writeIntern(QoreOracleConnection* conn, const char* ptr, size_t len, ExceptionSink* xsink);
+};
+
+class OracleLobInputStreamPriv : public InputStream {
+public:
+    DLLLOCAL OracleLobInputStreamPriv() : lob("ORACLELOBINPUTSTREAM-ERROR") {
+    }
+
+    DLLLOCAL int open(OracleLobPriv* l, ExceptionSink* xsink) {
+        return lob.open(l, false, xsink);
+    }
+
+    DLLLOCAL virtual const char* getName() {
+        return "OracleLobInputStream";
+    }
+
+    DLLLOCAL virtual int64 read(void* ptr, int64 limit, ExceptionSink* xsink) override {
+        return lob.read(ptr, limit, xsink);
+    }
+
+    DLLLOCAL virtual int64 peek(ExceptionSink* xsink) override {
+        return lob.peek(xsink);
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            lob.close(xsink);
+            delete this;
+        }
+    }
+
+    DLLLOCAL void close(ExceptionSink* xsink) {
+        lob.close(xsink);
+    }
+
+    DLLLOCAL OracleLobStream& getLob() {
+        return lob;
+    }
+
+private:
+    OracleLobStream lob;
+};
+
+class OracleLobOutputStreamPriv : public OutputStream {
+public:
+    DLLLOCAL OracleLobOutputStreamPriv() : lob("ORACLELOBOUTPUTSTREAM-ERROR") {
+    }
+
+    DLLLOCAL int open(OracleLobPriv* l, ExceptionSink* xsink) {
+        return lob.open(l, true, xsink);
+    }
+
+    DLLLOCAL virtual const char* getName() {
+        return "OracleLobOutputStream";
+    }
+
+    DLLLOCAL virtual void write(const void* ptr, int64 count, ExceptionSink* xsink) override {
+        lob.write(ptr, count, xsink);
+    }
+
+    //! finishes writing and closes the stream; the data is committed with the transaction of the datasource
+    DLLLOCAL virtual void close(ExceptionSink* xsink) override {
+        lob.close(xsink);
+    }
+
+    DLLLOCAL virtual bool isClosed() override {
+        return !lob.isOpen();
+    }
+
+    DLLLOCAL virtual void deref(ExceptionSink* xsink) {
+        if (ROdereference()) {
+            // the LOB must not be left open in the transaction
+            lob.close(xsink);
+            delete this;
+        }
+    }
+
+    DLLLOCAL OracleLobStream& getLob() {
+        return lob;
+    }
+
+private:
+    OracleLobStream lob;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleCallMonitor.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "oracle.h"
+
+QoreOracleCallMonitor oraCallMonitor;
+
+int QoreOracleCallMonitor::callStart(QoreOracleConnection* conn, unsigned timeout_ms, ExceptionSink* xsink) {
+    AutoLocker al(l);
+    assert(!conn->in_call);
+
+    if (timeout_ms) {
+        if (!watchdog_running) {
+            int rc;
+            if ((rc = pthread_create(&watchdog, NULL, &QoreOracleCallMonitor::thread_helper, this))) {
+                xsink->raiseErrnoException("THREAD-CREATION-FAILURE", rc, "could not create the call timeout "
+                    "watchdog thread");
+                return -1;
+            }
+            watchdog_running = true;
+        }
+
+        conn->call_deadline = q_clock_getmillis() + timeout_ms;
+        deadline_map_t::iterator i = deadlines.insert(deadline_map_t::value_type(conn->call_deadline, conn));
+        // wake up the watchdog if this is the next deadline
+        if (i == deadlines.begin())
+            c.signal();
+    } else
+        conn->call_deadline = 0;
+
+    conn->in_call = true;
+    conn->call_interrupted = 0;
+    return 0;
+}
+
+void QoreOracleCallMonitor::callEnd(QoreOracleConnection* conn) {
+    AutoLocker al(l);
+    assert(conn->in_call);
+    conn->in_call = false;
+
+    if (conn->call_deadline) {
+        std::pair<deadline_map_t::iterator, deadline_map_t::iterator> r = deadlines.equal_range(conn->call_deadline);
+        for (deadline_map_t::iterator i = r.first; i != r.second; ++i) {
+            if (i->second == conn) {
+                deadlines.erase(i);
+                break;
+            }
+        }
+        conn->call_deadline = 0;
+    }
+}
+
+void QoreOracleCallMonitor::setCancelKey(QoreOracleConnection* conn, const std::string& key) {
+    AutoLocker al(l);
+    if (!conn->cancel_key.empty()) {
+        std::pair<cancel_map_t::iterator, cancel_map_t::iterator> r = cancel_keys.equal_range(conn->cancel_key);
+        for (cancel_map_t::iterator i = r.first; i != r.second; ++i) {
+            if (i->second == conn) {
+                cancel_keys.erase(i);
+                break;
+            }
+        }
+    }
+    conn->cancel_key = key;
+    if (!key.empty())
+        cancel_keys.insert(cancel_map_t::value_type(key, conn));
+}
+
+int QoreOracleCallMonitor::cancel(const char* key) {
+    AutoLocker al(l);
+    int rc = 0;
+    std::pair<cancel_map_t::iterator, cancel_map_t::iterator> r = cancel_keys.equal_range(key);
+    for (cancel_map_t::iterator i = r.first; i != r.second; ++i) {
+        if (i->second->in_call && !i->second->call_interrupted) {
+            interrupt(i->second, ORA_CALL_CANCELLED);
+            ++rc;
+        }
+    }
+    return rc;
+}
+
+void QoreOracleCallMonitor::interrupt(QoreOracleConnection* conn, int reason) {
+    //printd(5, "QoreOracleCallMonitor::interrupt() conn: %p reason: %d\n", conn, reason);
+    conn->call_interrupted = reason;
+    // a separate error handle is used, as the connection's error handle is in use by the call
+    OCIBreak(conn->svchp, conn->brk_errhp);
+}
+
+void QoreOracleCallMonitor::shutdown() {
+    {
+        AutoLocker al(l);
+        if (!watchdog_running)
+            return;
+        quit = true;
+        c.signal();
+    }
+    pthread_join(watchdog, 0);
+    watchdog_running = false;
+}
+
+void QoreOracleCallMonitor::run() {
+    AutoLocker al(l);
+    while (!quit) {
+        if (deadlines.empty()) {
+            c.wait(l);
+            continue;
+        }
+
+        int64 now = q_clock_getmillis();
+        // interrupt all calls past their deadline
+        while (!deadlines.empty() && deadlines.begin()->first <= now) {
+            QoreOracleConnection* conn = deadlines.begin()->second;
+            deadlines.erase(deadlines.begin());
+            conn->call_deadline = 0;
+            if (!conn->call_interrupted)
+                interrupt(conn, ORA_CALL_TIMEOUT);
+        }
+
+        if (!deadlines.empty())
+            c.wait(l, (int)(deadlines.begin()->first - now));
+    }
+}
@@ -0,0 +1,123 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleCallMonitor.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef _QORE_ORACLECALLMONITOR_H
+#define _QORE_ORACLECALLMONITOR_H
+
+#include <map>
+#include <string>
+
+#include <pthread.h>
+
+//! interrupts calls in progress on connections when they time out or are cancelled from another thread
+/** calls are interrupted with OCIBreak(), which is safe to call while another thread is in a call on the connection
+*/
+class QoreOracleCallMonitor {
+public:
+    DLLLOCAL QoreOracleCallMonitor() {
+    }
+
+    DLLLOCAL ~QoreOracleCallMonitor() {
+        assert(deadlines.empty());
+        assert(cancel_keys.empty());
+    }
+
+    //! registers the start of a call; if timeout_ms > 0, the call is interrupted by the watchdog thread after the timeout
+    DLLLOCAL int callStart(QoreOracleConnection* conn, unsigned timeout_ms, ExceptionSink* xsink);
+
+    //! registers the end of a call
+    DLLLOCAL void callEnd(QoreOracleConnection* conn);
+
+    //! sets the cancel key of the connection; an empty key removes the connection from the cancel registry
+    DLLLOCAL void setCancelKey(QoreOracleConnection* conn, const std::string& key);
+
+    //! interrupts the calls in progress on all connections with the given cancel key; returns the number of calls
+    DLLLOCAL int cancel(const char* key);
+
+    //! stops the watchdog thread; called when the module is deleted
+    DLLLOCAL void shutdown();
+
+private:
+    typedef std::multimap<int64, QoreOracleConnection*> deadline_map_t;
+    typedef std::multimap<std::string, QoreOracleConnection*> cancel_map_t;
+
+    QoreThreadLock l;
+    QoreCondition c;
+    // calls with a timeout by their deadline in milliseconds
+    deadline_map_t deadlines;
+    // connections by their cancel key
+    cancel_map_t cancel_keys;
+    pthread_t watchdog;
+    bool watchdog_running = false,
+        quit = false;
+
+    //! interrupts the call in progress on the connection; must be called with the lock held
+    DLLLOCAL void interrupt(QoreOracleConnection* conn, int reason);
+
+    DLLLOCAL void run();
+
+    DLLLOCAL static void* thread_helper(void* context) {
+        ((QoreOracleCallMonitor*)context)->run();
+        return 0;
+    }
+};
+
+DLLLOCAL extern QoreOracleCallMonitor oraCallMonitor;
+
+//! registers a call on a connection with the call monitor for the lifetime of the object
+/** the object must only be in scope for the OCI call itself, as the connection can be deleted when errors are
+    handled
+*/
+class QoreOracleCallHelper {
+public:
+    DLLLOCAL QoreOracleCallHelper(QoreOracleConnection& conn, ExceptionSink* xsink) : conn(conn),
+            monitored(conn.isCallMonitored()) {
+        if (monitored && oraCallMonitor.callStart(&conn, conn.getWatchdogTimeout(), xsink)) {
+            monitored = false;
+            rc = -1;
+        }
+    }
+
+    DLLLOCAL ~QoreOracleCallHelper() {
+        if (monitored) {
+            oraCallMonitor.callEnd(&conn);
+            // reset the protocol after a break; the break error handle is used so that the error of the interrupted
+            // call is kept
+            if (conn.call_interrupted)
+                OCIReset(conn.svchp, conn.brk_errhp);
+        }
+    }
+
+    //! returns 0 if the call can be made or -1 if an exception was raised
+    DLLLOCAL int check() const {
+        return rc;
+    }
+
+private:
+    QoreOracleConnection& conn;
+    bool monitored;
+    int rc = 0;
+};
+
+#endif
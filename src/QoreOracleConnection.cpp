@@ -22,13 +22,121 @@
 */
 
 #include "oracle.h"
+#include "OracleLobStreamPriv.h"
 
 #include "ocilib_internal.h"
 
+#include <map>
+
+// a shared OCI environment handle and the number of connections using it
+struct ora_env_ref {
+    OCIEnv* envhp;
+    unsigned refs;
+};
+
+// shared OCI environments keyed by character set ID and mode
+typedef std::map<std::pair<ub2, ub4>, ora_env_ref> ora_env_map_t;
+static ora_env_map_t ora_env_map;
+static QoreThreadLock ora_env_lck;
+
+OCIEnv* QoreOracleEnvironment::acquire(ub2 charset, ub4 mode) {
+    AutoLocker al(ora_env_lck);
+
+    ora_env_map_t::iterator i = ora_env_map.find(std::make_pair(charset, mode));
+    if (i != ora_env_map.end()) {
+        ++i->second.refs;
+        return i->second.envhp;
+    }
+
+    OCIEnv* envhp = 0;
+    sword rc = charset
+        ? OCIEnvNlsCreate(&envhp, mode, 0, 0, 0, 0, 0, 0, charset, charset)
+        : OCIEnvCreate(&envhp, mode, 0, 0, 0, 0, 0, 0);
+    if (rc != OCI_SUCCESS) {
+        if (envhp)
+            OCIHandleFree(envhp, OCI_HTYPE_ENV);
+        return 0;
+    }
+
+    ora_env_ref ref = { envhp, 1 };
+    ora_env_map.insert(ora_env_map_t::value_type(std::make_pair(charset, mode), ref));
+    //printd(5, "QoreOracleEnvironment::acquire() created shared envhp: %p charset: %d mode: %d\n", envhp, charset, mode);
+    return envhp;
+}
+
+void QoreOracleEnvironment::release(OCIEnv* envhp, ub2 charset, ub4 mode) {
+    AutoLocker al(ora_env_lck);
+
+    ora_env_map_t::iterator i = ora_env_map.find(std::make_pair(charset, mode));
+    assert(i != ora_env_map.end());
+    assert(i->second.envhp == envhp);
+    assert(i->second.refs);
+    // the environment with the default character set is used for character set lookups for every new
+    // connection, so it is kept until the module is deleted
+    if (--i->second.refs || !charset)
+        return;
+    OCIHandleFree(envhp, OCI_HTYPE_ENV);
+    ora_env_map.erase(i);
+}
+
+// character set lookups cached process-wide
+static QoreThreadLock ora_cs_lck;
+// Oracle character set names to IDs
+typedef std::map<std::string, ub2> ora_cs_id_map_t;
+static ora_cs_id_map_t ora_cs_id_map;
+// character set name mappings, keyed by the direction and the name
+typedef std::map<std::pair<int, std::string>, std::string> ora_cs_name_map_t;
+static ora_cs_name_map_t ora_cs_name_map;
+
+unsigned short QoreOracleEnvironment::lookupCharSetId(const char* name) {
+    AutoLocker al(ora_cs_lck);
+
+    ora_cs_id_map_t::iterator i = ora_cs_id_map.find(name);
+    if (i != ora_cs_id_map.end())
+        return i->second;
+
+    QoreOracleEnvironment tmpenv;
+    if (tmpenv.init())
+        return 0;
+
+    ub2 id = tmpenv.nlsCharSetNameToId(name);
+    ora_cs_id_map[name] = id;
+    return id;
+}
+
+int QoreOracleEnvironment::lookupNameMap(const char* name, QoreString& out, int dir) {
+    AutoLocker al(ora_cs_lck);
+
+    std::pair<int, std::string> key(dir, name);
+    ora_cs_name_map_t::iterator i = ora_cs_name_map.find(key);
+    if (i != ora_cs_name_map.end()) {
+        out.set(i->second.c_str());
+        return 0;
+    }
+
+    QoreOracleEnvironment tmpenv;
+    if (tmpenv.init() || tmpenv.nlsNameMap(name, out, dir))
+        return -1;
+
+    ora_cs_name_map[key] = out.c_str();
+    return 0;
+}
+
+void QoreOracleEnvironment::cleanup() {
+    AutoLocker al(ora_env_lck);
+
+    for (ora_env_map_t::iterator i = ora_env_map.begin(), e = ora_env_map.end(); i != e; ++i)
+        OCIHandleFree(i->second.envhp, OCI_HTYPE_ENV);
+    ora_env_map.clear();
+}
+
 // ensure that numeric values are returned with no thousands separator and a dot decimal separator
 // despite the locale because we currently retrieve number values as strings
 static char session_sql[] = "alter session set nls_numeric_characters = \". \"";
 
+// the tag of pooled sessions where the session setup has been made
+static const char ora_session_tag[] = "QORE_SESSION_SETUP";
+
 QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsink)
   : errhp(0), svchp(0), srvhp(0), usrhp(0), ocilib_cn(0), ds(n_ds), ocilib_init(false),
     server_tz(currentTZ()),
@@ -48,28 +156,23 @@ QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsin
 
    QoreString encoding;
 
-   {
-      // create temporary environment handle
-      QoreOracleEnvironment tmpenv;
-      tmpenv.init();
-
-      if (ds.getDBEncoding()) {
-         set_charset = true;
-
-         // get character set ID
-         charsetid = tmpenv.nlsCharSetNameToId(ds.getDBEncoding());
-      } else { // get Oracle character set name from OS character set name
-         if (tmpenv.nlsNameMapToOracle(QCS_DEFAULT->getCode(), encoding) != OCI_SUCCESS) {
-            xsink->raiseException("DBI:ORACLE:UNKNOWN-CHARACTER-ENCODING", "cannot map default OS encoding '%s' to Oracle character encoding", QCS_DEFAULT->getCode());
-            return;
-         }
-         ds.setDBEncoding(encoding.getBuffer());
-         ds.setQoreEncoding(QCS_DEFAULT);
-
-         // get character set ID
-         charsetid = tmpenv.nlsCharSetNameToId(encoding.getBuffer());
-         // printd(5, "QoreOracleConnection::QoreOracleConnection() setting Oracle encoding to '%s' from default OS encoding '%s'\n", charset, QCS_DEFAULT->getCode());
+   // character set lookups are cached, so they are only made against an environment handle once per process
+   if (ds.getDBEncoding()) {
+      set_charset = true;
+
+      // get character set ID
+      charsetid = QoreOracleEnvironment::lookupCharSetId(ds.getDBEncoding());
+   } else { // get Oracle character set name from OS character set name
+      if (QoreOracleEnvironment::lookupNameMap(QCS_DEFAULT->getCode(), encoding, OCI_NLS_CS_IANA_TO_ORA)) {
+         xsink->raiseException("DBI:ORACLE:UNKNOWN-CHARACTER-ENCODING", "cannot map default OS encoding '%s' to Oracle character encoding", QCS_DEFAULT->getCode());
+         return;
       }
+      ds.setDBEncoding(encoding.getBuffer());
+      ds.setQoreEncoding(QCS_DEFAULT);
+
+      // get character set ID
+      charsetid = QoreOracleEnvironment::lookupCharSetId(encoding.getBuffer());
+      // printd(5, "QoreOracleConnection::QoreOracleConnection() setting Oracle encoding to '%s' from default OS encoding '%s'\n", charset, QCS_DEFAULT->getCode());
    }
 
    if (!charsetid) {
@@ -78,7 +181,7 @@ QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsin
    }
 
    // printd(5, "Oracle character encoding '%s' has ID %d, OCI_FLAGS=%d\n", charset, charsetid, OCI_FLAGS);
-   // create environment with default character set
+   // get the environment shared by all connections with this character set
    if (env.init(charsetid)) {
       xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "error creating new environment handle with encoding '%s'", ds.getDBEncoding());
       return;
@@ -89,7 +192,7 @@ QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsin
    // map the Oracle character set to a qore character set
    if (set_charset) {
       // map Oracle character encoding name to QORE/OS character encoding name
-      if (!env.nlsNameMapToQore(ds.getDBEncoding(), encoding)) {
+      if (!QoreOracleEnvironment::lookupNameMap(ds.getDBEncoding(), encoding, OCI_NLS_CS_ORA_TO_IANA)) {
          //printd(5, "QoreOracleConnection::QoreOracleConnection() Oracle character encoding '%s' mapped to '%s' character encoding\n", ds.getDBEncoding(), encoding.getBuffer());
          assert(encoding.strlen());
          ds.setQoreEncoding(encoding.getBuffer());
@@ -100,23 +203,36 @@ QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsin
       }
    }
 
+   // options that determine how the connection is opened
+   if (processConnectOptions(xsink))
+      return;
+
    // cannot use handleAlloc() here as we are allocating errhp now
    if (OCIHandleAlloc(*env, (dvoid **) &errhp, OCI_HTYPE_ERROR, 0, 0) != OCI_SUCCESS) {
       xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate error handle for connection");
       return;
    }
 
-   if (OCIHandleAlloc(*env, (dvoid **) &svchp, OCI_HTYPE_SVCCTX, 0, 0) != OCI_SUCCESS) {
+   // calls are interrupted from other threads with a separate error handle
+   if (OCIHandleAlloc(*env, (dvoid **) &brk_errhp, OCI_HTYPE_ERROR, 0, 0) != OCI_SUCCESS) {
+      brk_errhp = 0;
+      xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate error handle for connection");
+      return;
+   }
+
+   // the service context, server, and session handles of pooled sessions are owned by the session pool
+   if (!session_pool && OCIHandleAlloc(*env, (dvoid **) &svchp, OCI_HTYPE_SVCCTX, 0, 0) != OCI_SUCCESS) {
        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate service handle for connection");
        return;
    }
 
-   if (OCIHandleAlloc(*env, (dvoid **) &srvhp, OCI_HTYPE_SERVER, 0, 0) != OCI_SUCCESS) {
+   // shared server handles are owned by the shared server attachment
+   if (!session_pool && server_multiplex < 2 && OCIHandleAlloc(*env, (dvoid **) &srvhp, OCI_HTYPE_SERVER, 0, 0) != OCI_SUCCESS) {
        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate server handle for connection");
        return;
    }
 
-   if (OCIHandleAlloc(*env, (dvoid **) &usrhp, OCI_HTYPE_SESSION, 0, 0) != OCI_SUCCESS) {
+   if (!session_pool && OCIHandleAlloc(*env, (dvoid **) &usrhp, OCI_HTYPE_SESSION, 0, 0) != OCI_SUCCESS) {
        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate session handle for connection");
        return;
    }
@@ -131,6 +247,8 @@ QoreOracleConnection::QoreOracleConnection(Datasource &n_ds, ExceptionSink *xsin
 
    //printd(5, "QoreOracleConnection::QoreOracleConnection() datasource %p for DB=%s open (envhp=%p)\n", &ds, cstr.getBuffer(), *env);
 
+   // the OCILIB state refers to the shared environment but stays per connection, as it reports all errors through
+   // the connection's error handle; it allocates no OCI handles of its own
    if (!OCI_Initialize2(&ocilib, *env, errhp, ocilib_err_handler, 0, QORE_OCI_FLAGS)) {
       xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate OCILIB support handlers");
       return;
@@ -178,9 +296,18 @@ QoreOracleConnection::~QoreOracleConnection() {
    //printd(5, "QoreOracleConnection::~QoreOracleConnection() this=%p ds=%p envhp=%p svchp=%p ocilib envhp=%p\n", this, &ds, *env, svchp, ocilib.env);
    //printd(5, "QoreOracleConnection::~QoreOracleConnection(): connection to %s closed.\n", ds.getDBName());
    //printd(5, "QoreOracleConnection::~QoreOracleConnection(): svchp, errhp: %p, %p\n", svchp, errhp);
+   if (!cancel_key.empty())
+      oraCallMonitor.setCancelKey(this, std::string());
+
    if (svchp)
       logoff();
 
+   if (spool)
+      spool->deref();
+
+   if (authp)
+      OCIHandleFree(authp, OCI_HTYPE_AUTHINFO);
+
    if (ocilib_cn) {
       if (ocilib_cn->tinfs)
          OCI_ListFree(&ocilib, ocilib_cn->tinfs);
@@ -204,6 +331,8 @@ QoreOracleConnection::~QoreOracleConnection() {
 
    if (errhp)
       OCIHandleFree(errhp, OCI_HTYPE_ERROR);
+   if (brk_errhp)
+      OCIHandleFree(brk_errhp, OCI_HTYPE_ERROR);
 
    if (srvhp)
        OCIHandleFree(srvhp, (ub4) OCI_HTYPE_SERVER);
@@ -274,21 +403,86 @@ int QoreOracleConnection::checkerr(sword status, const char* query_name, Excepti
     return -1;
 }
 
-bool QoreOracleConnection::handleError(ExceptionSink* xsink, const char* who, bool can_retry) {
-    // see if we have a lost connection from the error code
-    int ping = -1;
+// returns 0 if the error means that the connection has been lost, 1 if the connection is still usable, and -1 if
+// it can't be determined from the error code
+static int ora_error_connected(sb4 errcode) {
+    switch (errcode) {
+        // ORA-03113 and ORA-03114 are lost connections
+        case 3113:
+        case 3114:
+        // issue #802: ORA-01041 is only raised due to a bug in Oracle pre 12c
+        case 1041:
+        case 28:    // session killed
+        case 1012:  // not logged on
+        case 1033:  // initialization or shutdown in progress
+        case 1034:  // Oracle not available
+        case 1089:  // immediate shutdown in progress
+        case 1092:  // instance terminated
+        case 2396:  // exceeded maximum idle time
+        case 3135:  // connection lost contact
+        case 12152: // TNS: unable to send break message
+        case 12153: // TNS: not connected
+        case 12537: // TNS: connection closed
+        case 12547: // TNS: lost contact
+        case 12570: // TNS: packet reader failure
+        case 12571: // TNS: packet writer failure
+        case 12583: // TNS: no reader
+        case 12592: // TNS: bad packet
+            return 0;
 
+        case 1:     // unique constraint violated
+        case 54:    // resource busy
+        case 60:    // deadlock detected
+        case 904:   // invalid identifier
+        case 942:   // table or view does not exist
+        case 1013:  // user requested cancel of current operation
+        case 1400:  // cannot insert NULL
+        case 1401:  // inserted value too large
+        case 1403:  // no data found
+        case 1407:  // cannot update to NULL
+        case 1410:  // invalid ROWID
+        case 1422:  // exact fetch returns more than requested number of rows
+        case 1438:  // value larger than specified precision
+        case 1476:  // divisor is equal to zero
+        case 1722:  // invalid number
+        case 2290:  // check constraint violated
+        case 2291:  // integrity constraint violated - parent key not found
+        case 2292:  // integrity constraint violated - child record found
+        case 4061:  // existing state of package has been invalidated
+        case 4068:  // existing state of packages has been discarded
+        case 6502:  // PL/SQL: numeric or value error
+        case 6550:  // PL/SQL compilation error
+        case 12899: // value too large for column
+            return 1;
+    }
+
+    // SQL parse errors, date and time conversion errors, and errors raised by applications
+    if ((errcode >= 900 && errcode <= 999) || (errcode >= 1800 && errcode <= 1899)
+        || (errcode >= 20000 && errcode <= 20999))
+        return 1;
+
+    return -1;
+}
+
+bool QoreOracleConnection::handleError(ExceptionSink* xsink, const char* who, bool can_retry) {
     // get and save error information
     sb4 errcode;
     text errbuf[512];
     OCIErrorGet((dvoid*)errhp, (ub4)1, (text*)nullptr, &errcode, errbuf, (ub4)sizeof(errbuf), OCI_HTYPE_ERROR);
-    // ORA-03113 and ORA-03114 are lost connections
-    // issue #802: ORA-01041 is only raised due to a bug in Oracle pre 12c
-    if (errcode == 3113 || errcode == 3114 || errcode == 1041)
-        ping = 0;
+
+    // see if we have a lost connection from the error code
+    int ping = ora_error_connected(errcode);
+
+    // check the server handle's status, which is known locally without a round trip
+    if (ping == -1 && srvhp) {
+        ub4 status = OCI_SERVER_NORMAL;
+        if (OCIAttrGet(srvhp, OCI_HTYPE_SERVER, &status, 0, OCI_ATTR_SERVER_STATUS, errhp) == OCI_SUCCESS
+            && status == OCI_SERVER_NOT_CONNECTED)
+            ping = 0;
+    }
 
     //dbg();
-    // see if server is connected
+    // only ping the server if the connection state cannot be determined otherwise
     if (ping == -1 && ocilib_init) {
         ExceptionSink xsink2;
         ping = OCI_Ping(&ocilib, ocilib_cn, &xsink2);
@@ -297,77 +491,114 @@ bool QoreOracleConnection::handleError(ExceptionSink* xsink, const char* who, bo
     }
 
     if (!ping) {
-        // if there is at least one SQLStatement active on the connection, there will be a transaction in place
-        // therefore in all cases all statements will be invalidated and closed when we lose a connection
-        // we can only recover a plain "exec" or "select" call
-        if (ds.activeTransaction()) {
-            xsink->raiseException("DBI:ORACLE:TRANSACTION-ERROR", "connection to Oracle database server %s@%s lost " \
-                "while in a transaction; transaction has been lost", ds.getUsername(), ds.getDBName());
+        // a connection lost while rows are fetched ahead in a helper thread is handled in the thread using the
+        // connection when the rows are retrieved
+        if (fetch_ahead_running) {
+            session_lost = true;
+            fetch_ahead_lost = true;
+            doException(who, errbuf, errcode, xsink);
+            return false;
         }
+        return handleLostConnection(xsink, can_retry);
+    }
 
-        // reset current statement state while the driver-specific context data is still present
-        for (auto& i : stmt_set) {
-            i->clear(xsink);
-        }
-        // free and reset statement states for all active statements while the driver-specific context data is still present
-        ds.connectionLost(xsink);
-
-        if (can_retry) {
-            // try to reconnect
-            logoff();
-
-            //printd(5, "QoreOracleStatement::execute() about to execute OCILogon() for reconnect (trans: %d)\n", ds->activeTransaction());
-            if (logon(xsink)) {
-                //printd(5, "QoreOracleStatement::execute() conn: %p reconnect failed, marking connection as closed\n", &conn);
-                // free state completely
-                for (auto& i : stmt_set) {
-                    i->reset(xsink);
-                }
-                // close datasource and remove private data
-                ds.connectionAborted(xsink);
-                return false;
-            }
+    //printd(5, "QoreOracleStatement::execute() error, but it's connected; status: %d who: %s\n", status, who);
+    doException(who, errbuf, errcode, xsink);
+    return false;
+}
 
-            // clear warnings
-            clearWarnings();
+bool QoreOracleConnection::handleLostConnection(ExceptionSink* xsink, bool can_retry) {
+    session_lost = true;
 
-            // don't execute again if any exceptions have occured, including if the connection was aborted while in a transaction
-            if (*xsink) {
-                // close all statements and remove private data but leave datasource open
-                ds.connectionRecovered(xsink);
-                return false;
-            }
+    // if there is at least one SQLStatement active on the connection, there will be a transaction in place
+    // therefore in all cases all statements will be invalidated and closed when we lose a connection
+    // we can only recover a plain "exec" or "select" call
+    if (ds.activeTransaction()) {
+        xsink->raiseException("DBI:ORACLE:TRANSACTION-ERROR", "connection to Oracle database server %s@%s lost " \
+            "while in a transaction; transaction has been lost", ds.getUsername(), ds.getDBName());
+    }
+
+    // reset current statement state while the driver-specific context data is still present
+    for (auto& i : stmt_set) {
+        i->clear(xsink);
+    }
+    // free and reset statement states for all active statements while the driver-specific context data is still present
+    ds.connectionLost(xsink);
+
+    if (can_retry) {
+        // try to reconnect
+        logoff();
 
+        //printd(5, "QoreOracleStatement::execute() about to execute OCILogon() for reconnect (trans: %d)\n", ds->activeTransaction());
+        if (logon(xsink)) {
+            //printd(5, "QoreOracleStatement::execute() conn: %p reconnect failed, marking connection as closed\n", &conn);
+            // free state completely
             for (auto& i : stmt_set) {
-                // try to recreate the statement context
-                if (i->rebindAbortedConnection(xsink))
-                    return false;
+                i->reset(xsink);
             }
+            // close datasource and remove private data
+            ds.connectionAborted(xsink);
+            return false;
+        }
+
+        // clear warnings
+        clearWarnings();
 
-            return true;
+        // don't execute again if any exceptions have occured, including if the connection was aborted while in a transaction
+        if (*xsink) {
+            // close all statements and remove private data but leave datasource open
+            ds.connectionRecovered(xsink);
+            return false;
         }
 
         for (auto& i : stmt_set) {
-            i->reset(xsink);
+            // try to recreate the statement context
+            if (i->rebindAbortedConnection(xsink))
+                return false;
         }
-        // close datasource and remove private data
-        ds.connectionAborted(xsink);
-        return false;
+
+        return true;
     }
 
-    //printd(5, "QoreOracleStatement::execute() error, but it's connected; status: %d who: %s\n", status, who);
-    doException(who, errbuf, errcode, xsink);
+    for (auto& i : stmt_set) {
+        i->reset(xsink);
+    }
+    // close datasource and remove private data
+    ds.connectionAborted(xsink);
     return false;
 }
 
+void QoreOracleConnection::quiesceIntern() {
+    assert(fetch_ahead_call);
+    fetch_ahead_call->wait();
+    assert(!fetch_ahead_call);
+}
+
+void QoreOracleConnection::invalidateLobs() {
+    AutoLocker al(OracleLobPriv::registry_lock);
+    for (auto& i : lob_set) {
+        i->invalidate();
+    }
+    lob_set.clear();
+}
+
 int QoreOracleConnection::doException(const char *query_name, text errbuf[], sb4 errcode, ExceptionSink *xsink) {
+    // calls interrupted after a timeout or when cancelled fail with ORA-01013; ORA-03156 is raised when the call
+    // timeout is enforced by the client library
+    const char* err = "DBI:ORACLE:OCI-ERROR";
+    if (errcode == 3156 || (errcode == 1013 && call_interrupted == ORA_CALL_TIMEOUT))
+        err = "DBI:ORACLE:CALL-TIMEOUT";
+    else if (errcode == 1013 && call_interrupted == ORA_CALL_CANCELLED)
+        err = "DBI:ORACLE:CALL-CANCELLED";
+    call_interrupted = 0;
+
     // add ORA-xxxxx code to exception in arg hash in the "alterr" key
     QoreHashNode* arg = new QoreHashNode;
     arg->setKeyValue("alterr", new QoreStringNodeMaker("OCI-%05d", (int)errcode), xsink);
     if (query_name)
-       xsink->raiseExceptionArg("DBI:ORACLE:OCI-ERROR", arg, "%s@%s: %s: %s", ds.getUsername(), ds.getDBName(), query_name, remove_trailing_newlines((char *)errbuf));
+       xsink->raiseExceptionArg(err, arg, "%s@%s: %s: %s", ds.getUsername(), ds.getDBName(), query_name, remove_trailing_newlines((char *)errbuf));
     else
-       xsink->raiseExceptionArg("DBI:ORACLE:OCI-ERROR", arg, "%s@%s: %s", ds.getUsername(), ds.getDBName(), remove_trailing_newlines((char*)errbuf));
+       xsink->raiseExceptionArg(err, arg, "%s@%s: %s", ds.getUsername(), ds.getDBName(), remove_trailing_newlines((char*)errbuf));
     return -1;
 }
 
@@ -387,6 +618,17 @@ int QoreOracleConnection::logon(ExceptionSink *xsink) {
    }
    dblink.concat(ds.getDBName());
 
+   // DRCP is requested with the :POOLED suffix of the easy connect string; TNS aliases need (SERVER=POOLED) in the
+   // connect descriptor instead
+   if (drcp && strchr(dblink.c_str(), '/')
+      && (dblink.size() < 7 || strcasecmp(dblink.c_str() + dblink.size() - 7, ":POOLED")))
+      dblink.concat(":POOLED");
+
+   session_lost = false;
+
+   if (session_pool)
+      return sessionGet(dblink, xsink);
+
    int e;
 
    // user session login creds.
@@ -396,16 +638,38 @@ int QoreOracleConnection::logon(ExceptionSink *xsink) {
    e = checkerr(OCIAttrSet(usrhp, OCI_HTYPE_SESSION, (text *)pass.c_str(), pass.size(), OCI_ATTR_PASSWORD, errhp), "QoreOracleConnection::logon() Set password", xsink);
    if (e) return -1;
 
-   /* attach to the server - use default host? */
-   e = checkerr(OCIServerAttach(srvhp, errhp, (text *)dblink.getBuffer(), dblink.size(), (ub4) OCI_DEFAULT), "QoreOracleConnection::logon() server attach", xsink);
-   if (e) return -1;
+   if (setDrcpAttributes(usrhp, xsink))
+      return -1;
+
+   if (server_multiplex > 1) {
+      // the session is added to a server attachment shared with other connections
+      assert(!shared_srv);
+      shared_srv = QoreOracleSharedServer::get(*this, dblink, server_multiplex, xsink);
+      if (!shared_srv)
+         return -1;
+      srvhp = shared_srv->getServer();
+      if (ocilib_cn)
+         ocilib_cn->svr = srvhp;
+      // a call in progress while reconnecting keeps the new attachment until it ends
+      if (srv_calls)
+         shared_srv->callStart(0);
+   } else {
+      /* attach to the server - use default host? */
+      e = checkerr(OCIServerAttach(srvhp, errhp, (text *)dblink.getBuffer(), dblink.size(), (ub4) OCI_DEFAULT), "QoreOracleConnection::logon() server attach", xsink);
+      if (e) return -1;
+   }
 
    /* set the server attribute in the service context */
    e = checkerr(OCIAttrSet(svchp, OCI_HTYPE_SVCCTX, srvhp, 0, OCI_ATTR_SERVER, errhp), "QoreOracleConnection::logon() server to service context", xsink);
    if (e) return -1;
 
    /* log on */
-   e = checkerr(OCISessionBegin(svchp, errhp, usrhp, OCI_CRED_RDBMS, OCI_DEFAULT), "QoreOracleConnection::logon() session begin", xsink);
+   {
+      QoreOracleServerCallHelper sch(*this, xsink);
+      if (sch.check())
+         return -1;
+      e = checkerr(OCISessionBegin(svchp, errhp, usrhp, OCI_CRED_RDBMS, OCI_DEFAULT), "QoreOracleConnection::logon() session begin", xsink);
+   }
    if (e) return -1;
 
    /* set the session attribute in the service context */
@@ -416,9 +680,281 @@ int QoreOracleConnection::logon(ExceptionSink *xsink) {
 
    //printd(5, "QoreOracleConnection::logon() %s/%s@%s succeeded\n", user.c_str(), pass.c_str(), dblink.getBuffer());
 
+   // the session NLS settings are made before the first statement is executed on the session instead of here, so
+   // that sessions that never execute a statement do not need the round trip; see QorePreparedStatement::execute()
+   session_setup_pending = true;
+
+   if (call_timeout)
+      setCallTimeout();
+   return 0;
+}
+
+void QoreOracleConnection::setCallTimeout() {
+#ifdef OCI_ATTR_CALL_TIMEOUT
+   // the call timeout is enforced by Oracle 18c+ client libraries; otherwise the watchdog thread is used
+   // calls on a shared server attachment are not interrupted, as that would break the calls of other sessions
+   ub4 ms = call_timeout;
+   native_call_timeout = svchp && !shared_srv
+      && OCIAttrSet(svchp, OCI_HTYPE_SVCCTX, &ms, 0, OCI_ATTR_CALL_TIMEOUT, brk_errhp) == OCI_SUCCESS;
+#else
+   native_call_timeout = false;
+#endif
+}
+
+int QoreOracleConnection::setCancelKey(QoreValue val, ExceptionSink* xsink) {
+   std::string key;
+   if (!val.isNullOrNothing()) {
+      if (server_multiplex > 1) {
+         xsink->raiseException("ORACLE-OPTION-ERROR", "the '" ORA_OPT_CANCEL_KEY "' option cannot be used with the '"
+            ORA_OPT_SERVER_MULTIPLEX "' option, as cancelling a call would break the calls of the other sessions "
+            "sharing the server attachment");
+         return -1;
+      }
+      QoreStringValueHelper str(val, QCS_DEFAULT, xsink);
+      if (*xsink)
+         return -1;
+      key = str->c_str();
+   }
+   oraCallMonitor.setCancelKey(this, key);
+   return 0;
+}
+
+int QoreOracleConnection::sessionGet(const QoreString& dblink, ExceptionSink* xsink) {
+   assert(!svchp);
+   if (!spool) {
+      spool = QoreOracleSessionPool::get(*this, dblink, xsink);
+      if (!spool)
+         return -1;
+   }
+
+   // DRCP attributes are passed with an authentication info handle, which contains no credentials, as the pool
+   // is homogeneous
+   if (!authp && (!connection_class.empty() || purity != OCI_ATTR_PURITY_DEFAULT)) {
+      if (handleAlloc((void**)&authp, OCI_HTYPE_AUTHINFO, "QoreOracleConnection::logon()", xsink)) {
+         authp = 0;
+         return -1;
+      }
+      if (setDrcpAttributes(authp, xsink))
+         return -1;
+   }
+
+   // pooled sessions that have already been set up are tagged
+   boolean found = FALSE;
+   OraText* rettag = 0;
+   ub4 rettag_len = 0;
+   if (checkerr(OCISessionGet(*env, errhp, &svchp, authp, (OraText*)spool->getName(), spool->getNameLen(),
+      (const OraText*)ora_session_tag, sizeof(ora_session_tag) - 1, &rettag, &rettag_len, &found, OCI_SESSGET_SPOOL),
+      "QoreOracleConnection::logon() get session from pool", xsink)) {
+      svchp = 0;
+      return -1;
+   }
+   session_setup_pending = !found;
+
+   if (checkerr(OCIAttrGet(svchp, OCI_HTYPE_SVCCTX, &srvhp, 0, OCI_ATTR_SERVER, errhp),
+         "QoreOracleConnection::logon() get the server handle of the pooled session", xsink)
+      || checkerr(OCIAttrGet(svchp, OCI_HTYPE_SVCCTX, &usrhp, 0, OCI_ATTR_SESSION, errhp),
+         "QoreOracleConnection::logon() get the session handle of the pooled session", xsink)) {
+      sessionRelease();
+      return -1;
+   }
+
+   // the handles change with every session taken from the pool
+   if (ocilib_cn) {
+      ocilib_cn->cxt = svchp;
+      ocilib_cn->svr = srvhp;
+      ocilib_cn->ses = usrhp;
+   }
+
+   if (call_timeout)
+      setCallTimeout();
+
+   return 0;
+}
+
+int QoreOracleConnection::sessionRelease() {
+   assert(svchp);
+   // sessions are tagged when they have been set up so that the setup is not repeated when they are reused;
+   // sessions on lost connections are dropped from the pool
+   ub4 mode = OCI_DEFAULT;
+   bool tag = false;
+   if (session_lost)
+      mode = OCI_SESSRLS_DROPSESS;
+   else if (!session_setup_pending) {
+      mode = OCI_SESSRLS_RETAG;
+      tag = true;
+   }
+   int rc = OCISessionRelease(svchp, errhp, tag ? (OraText*)ora_session_tag : 0, tag ? sizeof(ora_session_tag) - 1 : 0,
+      mode);
+   svchp = 0;
+   srvhp = 0;
+   usrhp = 0;
+   return rc;
+}
+
+int QoreOracleConnection::setDrcpAttributes(void* hndlp, ExceptionSink* xsink) {
+   if (!connection_class.empty() && checkerr(OCIAttrSet(hndlp, OCI_HTYPE_AUTHINFO, (void*)connection_class.c_str(),
+      connection_class.size(), OCI_ATTR_CONNECTION_CLASS, errhp), "QoreOracleConnection::logon() set connection class",
+      xsink))
+      return -1;
+   if (purity != OCI_ATTR_PURITY_DEFAULT && checkerr(OCIAttrSet(hndlp, OCI_HTYPE_AUTHINFO, &purity, 0, OCI_ATTR_PURITY,
+      errhp), "QoreOracleConnection::logon() set purity", xsink))
+      return -1;
+   return 0;
+}
+
+int QoreOracleConnection::serverCallStart(ExceptionSink* xsink) {
+   if (srv_calls++ || !shared_srv)
+      return 0;
+   if (shared_srv->callStart(call_timeout)) {
+      --srv_calls;
+      xsink->raiseException("DBI:ORACLE:CALL-TIMEOUT", "%s@%s: timed out after %u ms waiting for a call by another "
+         "session sharing the server attachment", ds.getUsername(), ds.getDBName(), call_timeout);
+      return -1;
+   }
+   return 0;
+}
+
+void QoreOracleConnection::serverCallEnd() {
+   assert(srv_calls);
+   if (!--srv_calls && shared_srv)
+      shared_srv->callEnd();
+}
+
+void QoreOracleConnection::releaseSharedServer() {
+   assert(shared_srv);
+   // a call in progress releases the attachment; it is acquired again when the session is reestablished
+   if (srv_calls)
+      shared_srv->callEnd();
+   // an attachment with a lost connection is not used for new sessions
+   shared_srv->release(session_lost);
+   shared_srv = nullptr;
+   srvhp = 0;
+}
+
+bool QoreOracleConnection::isConnectOption(const char* opt) {
+   return !strcasecmp(opt, ORA_OPT_SERVER_MULTIPLEX) || !strcasecmp(opt, ORA_OPT_DRCP) || !strcasecmp(opt, ORA_OPT_CONNECTION_CLASS)
+      || !strcasecmp(opt, ORA_OPT_PURITY) || !strcasecmp(opt, ORA_OPT_SESSION_POOL) || !strcasecmp(opt, ORA_OPT_SESSION_POOL_MIN)
+      || !strcasecmp(opt, ORA_OPT_SESSION_POOL_MAX) || !strcasecmp(opt, ORA_OPT_SESSION_POOL_INCREMENT)
+      || !strcasecmp(opt, ORA_OPT_SESSION_POOL_TIMEOUT) || !strcasecmp(opt, ORA_OPT_STMT_CACHE_SIZE);
+}
+
+int QoreOracleConnection::setConnectOption(const char* opt, QoreValue val, ExceptionSink* xsink) {
+   if (!strcasecmp(opt, ORA_OPT_SESSION_POOL) || !strcasecmp(opt, ORA_OPT_DRCP)) {
+      bool b = val.getType() == NT_STRING ? q_parse_bool(val.get<const QoreStringNode>()->c_str()) : val.getAsBool();
+      bool& v = !strcasecmp(opt, ORA_OPT_DRCP) ? drcp : session_pool;
+      if (connect_opts_done) {
+         if (b == v)
+            return 0;
+      } else {
+         v = b;
+         return 0;
+      }
+   } else if (!strcasecmp(opt, ORA_OPT_CONNECTION_CLASS)) {
+      QoreStringValueHelper str(val, QCS_DEFAULT, xsink);
+      if (*xsink)
+         return -1;
+      if (connect_opts_done) {
+         if (connection_class == str->c_str())
+            return 0;
+      } else {
+         connection_class = str->c_str();
+         return 0;
+      }
+   } else if (!strcasecmp(opt, ORA_OPT_PURITY)) {
+      QoreStringValueHelper str(val);
+      ub4 p;
+      if (!strcasecmp(str->c_str(), "default"))
+         p = OCI_ATTR_PURITY_DEFAULT;
+      else if (!strcasecmp(str->c_str(), "new"))
+         p = OCI_ATTR_PURITY_NEW;
+      else if (!strcasecmp(str->c_str(), "self"))
+         p = OCI_ATTR_PURITY_SELF;
+      else {
+         xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': '%s'; expecting \"default\", "
+            "\"new\", or \"self\"", opt, str->c_str());
+         return -1;
+      }
+      if (connect_opts_done) {
+         if (p == purity)
+            return 0;
+      } else {
+         purity = p;
+         return 0;
+      }
+   } else {
+      int64 v = val.getAsBigInt();
+      if (v < 0 || v > INT_MAX) {
+         xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value must be "
+            "zero or positive", opt, v);
+         return -1;
+      }
+
+      unsigned* p;
+      if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_MIN))
+         p = &session_pool_min;
+      else if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_MAX))
+         p = &session_pool_max;
+      else if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_INCREMENT))
+         p = &session_pool_incr;
+      else if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_TIMEOUT))
+         p = &session_pool_timeout;
+      else if (!strcasecmp(opt, ORA_OPT_SERVER_MULTIPLEX))
+         p = &server_multiplex;
+      else {
+         assert(!strcasecmp(opt, ORA_OPT_STMT_CACHE_SIZE));
+         p = &stmt_cache_size;
+      }
+
+      if (connect_opts_done) {
+         if ((unsigned)v == *p)
+            return 0;
+      } else {
+         *p = (unsigned)v;
+         return 0;
+      }
+   }
+
+   // options given for the datasource are set again after the connection has been opened
+   xsink->raiseException("ORACLE-OPTION-ERROR", "option '%s' can only be set before the connection is opened", opt);
+   return -1;
+}
+
+int QoreOracleConnection::processConnectOptions(ExceptionSink* xsink) {
+   ReferenceHolder<QoreHashNode> opts(ds.getConnectOptions(), xsink);
+   if (opts) {
+      ConstHashIterator i(*opts);
+      while (i.next()) {
+         if (isConnectOption(i.getKey()) && setConnectOption(i.getKey(), i.get(), xsink))
+            return -1;
+      }
+   }
+   connect_opts_done = true;
+
+   if (session_pool && server_multiplex > 1) {
+      xsink->raiseException("ORACLE-OPTION-ERROR", "the '" ORA_OPT_SESSION_POOL "' and '" ORA_OPT_SERVER_MULTIPLEX
+         "' options cannot be used together, as pooled sessions use the session pool's server attachments");
+      return -1;
+   }
+   if (!cancel_key.empty() && server_multiplex > 1) {
+      xsink->raiseException("ORACLE-OPTION-ERROR", "the '" ORA_OPT_CANCEL_KEY "' option cannot be used with the '"
+         ORA_OPT_SERVER_MULTIPLEX "' option, as cancelling a call would break the calls of the other sessions "
+         "sharing the server attachment");
+      return -1;
+   }
+   return 0;
+}
+
+int QoreOracleConnection::setupSession(sword& status, ExceptionSink* xsink) {
+   assert(session_setup_pending);
    // make sure we can read number characters
    QoreOracleSimpleStatement stmt(*this);
-   return stmt.exec(session_sql, sizeof(session_sql), xsink);
+   if ((!stmt && stmt.allocate(xsink)) || stmt.prepare(session_sql, sizeof(session_sql), xsink))
+      return -1;
+   // errors are handled by the caller, as a lost connection has to be handled like for the caller's statement
+   status = OCIStmtExecute(svchp, stmt.stmthp, errhp, 1, 0, 0, 0, OCI_DEFAULT);
+   if (status == OCI_SUCCESS || status == OCI_SUCCESS_WITH_INFO)
+      session_setup_pending = false;
+   return 0;
 }
 
 int QoreOracleConnection::descriptorAlloc(void** descpp, unsigned type, const char* who, ExceptionSink* xsink) {
@@ -481,7 +1017,117 @@ DateTimeNode* QoreOracleConnection::getTimestamp(bool get_tz, OCIDateTime *odt,
     return DateTimeNode::makeAbsolute(zone, year, month, day, hour, minute, second, ns / 1000);
 }
 
-BinaryNode *QoreOracleConnection::readBlob(OCILobLocator *lobp, ExceptionSink *xsink) {
+int QoreOracleConnection::setLobPrefetch(OCIDefine* defp, ExceptionSink* xsink) {
+#ifdef OCI_ATTR_LOBPREFETCH_SIZE
+    if (lob_prefetch_size) {
+        ub4 size = lob_prefetch_size;
+        if (checkerr(OCIAttrSet(defp, OCI_HTYPE_DEFINE, &size, 0, OCI_ATTR_LOBPREFETCH_SIZE, errhp),
+            "QoreOracleConnection::setLobPrefetch()", xsink))
+            return -1;
+    }
+    // always prefetch the LOB length so that buffers can be sized without a round trip
+    boolean prefetch_length = TRUE;
+    if (checkerr(OCIAttrSet(defp, OCI_HTYPE_DEFINE, &prefetch_length, 0, OCI_ATTR_LOBPREFETCH_LENGTH, errhp),
+        "QoreOracleConnection::setLobPrefetch()", xsink))
+        return -1;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+ub4 QoreOracleConnection::getLobPieceSize(OCILobLocator* lobp, unsigned width, ExceptionSink* xsink) {
+    ub4 chunk = 0;
+    if (checkerr(OCILobGetChunkSize(svchp, errhp, lobp, &chunk), "QoreOracleConnection::getLobPieceSize()", xsink))
+        return 0;
+    chunk *= width;
+    if (!chunk)
+        return LOB_PIECE_SIZE;
+    if (chunk >= LOB_PIECE_SIZE)
+        return chunk;
+    // use the largest multiple of the chunk size that fits in the piece size
+    return (LOB_PIECE_SIZE / chunk) * chunk;
+}
+
+#ifdef HAVE_OCILOBREAD2
+bool QoreOracleConnection::isLobPrefetched(oraub8 len) const {
+#ifdef OCI_ATTR_LOBPREFETCH_SIZE
+    return lob_prefetch_size && len <= (oraub8)lob_prefetch_size;
+#else
+    return false;
+#endif
+}
+#endif
+
+BinaryNode *QoreOracleConnection::readBlob(OCILobLocator *lobp, bool length_prefetched, ExceptionSink *xsink) {
+#ifdef HAVE_OCILOBREAD2
+    // getting the length of other locators (ex: output values and temporary LOBs) would need an extra round trip
+    if (!length_prefetched)
+        return readBlobStream(lobp, xsink);
+
+    oraub8 len;
+    if (checkerr(OCILobGetLength2(svchp, errhp, lobp, &len), "QoreOracleConnection::readBlob()", xsink))
+        return nullptr;
+
+    SimpleRefHolder<BinaryNode> b(new BinaryNode);
+    if (!len)
+        return b.release();
+
+    // read prefetched LOB data from the locator cache and values up to the piece size in one piece; the chunk size
+    // is only retrieved for larger values, which are read in chunk-aligned pieces
+    ub4 piece = 0;
+    if (!isLobPrefetched(len) && len > LOB_PIECE_SIZE && !(piece = getLobPieceSize(lobp, 1, xsink)))
+        return nullptr;
+
+    // read the data directly into the preallocated value
+    if (b->preallocate(len)) {
+        xsink->outOfMemory();
+        return nullptr;
+    }
+    char* ptr = (char*)b->getPtr();
+
+    if (!piece || len <= piece) {
+        oraub8 byte_amt = len;
+        oraub8 char_amt = 0;
+        if (checkerr(OCILobRead2(svchp, errhp, lobp, &byte_amt, &char_amt, 1, ptr, len, OCI_ONE_PIECE, 0, 0, 0,
+            SQLCS_IMPLICIT), "QoreOracleConnection::readBlob()", xsink))
+            return nullptr;
+        b->setSize(byte_amt);
+        return b.release();
+    }
+
+    oraub8 offset = 0;
+    oraub8 byte_amt = len;
+    oraub8 char_amt = 0;
+    ub1 mode = OCI_FIRST_PIECE;
+    while (true) {
+        oraub8 bufl = len - offset;
+        if (bufl > piece)
+            bufl = piece;
+        sword rc = OCILobRead2(svchp, errhp, lobp, &byte_amt, &char_amt, 1, ptr + offset, bufl, mode, 0, 0, 0,
+            SQLCS_IMPLICIT);
+        if (rc != OCI_NEED_DATA && checkerr(rc, "QoreOracleConnection::readBlob()", xsink))
+            return nullptr;
+        offset += byte_amt;
+        if (rc != OCI_NEED_DATA)
+            break;
+        if (offset >= len) {
+            // cannot happen unless the LOB was changed while it was being read
+            OCIBreak(svchp, errhp);
+            xsink->raiseException("DBI:ORACLE:LOB-ERROR", "QoreOracleConnection::readBlob(): BLOB data exceeds "
+                "the length returned by the server (" QLLD " bytes)", (int64)len);
+            return nullptr;
+        }
+        mode = OCI_NEXT_PIECE;
+    }
+    b->setSize(offset);
+    return b.release();
+#else
+    return readBlobStream(lobp, xsink);
+#endif
+}
+
+BinaryNode* QoreOracleConnection::readBlobStream(OCILobLocator* lobp, ExceptionSink* xsink) {
     // retrieve *LOB data
     void *dbuf = malloc(LOB_BLOCK_SIZE);
     ON_BLOCK_EXIT(free, dbuf);
@@ -494,7 +1140,94 @@ BinaryNode *QoreOracleConnection::readBlob(OCILobLocator *lobp, ExceptionSink *x
     return b.release();
 }
 
-QoreStringNode *QoreOracleConnection::readClob(OCILobLocator *lobp, const QoreEncoding *enc, ExceptionSink *xsink) {
+QoreStringNode *QoreOracleConnection::readClob(OCILobLocator *lobp, const QoreEncoding *enc, bool length_prefetched,
+        ExceptionSink *xsink) {
+#ifdef HAVE_OCILOBREAD2
+    // getting the length of other locators (ex: output values and temporary LOBs) would need an extra round trip
+    if (!length_prefetched)
+        return readClobStream(lobp, enc, xsink);
+
+    // the length of a CLOB is returned in characters
+    oraub8 len;
+    if (checkerr(OCILobGetLength2(svchp, errhp, lobp, &len), "QoreOracleConnection::readClob()", xsink))
+        return nullptr;
+
+    QoreStringNodeHolder str(new QoreStringNode(enc));
+    if (!len)
+        return str.release();
+
+    // the maximum size of the data in bytes
+    oraub8 max_size = len * enc->getMaxCharWidth();
+
+    // read prefetched LOB data from the locator cache and values up to the piece size in one piece; the chunk size
+    // is only retrieved for larger values, which are read in chunk-aligned pieces
+    ub4 piece = 0;
+    if (!isLobPrefetched(len) && max_size > LOB_PIECE_SIZE
+        && !(piece = getLobPieceSize(lobp, enc->getMaxCharWidth(), xsink)))
+        return nullptr;
+
+    if (!piece || max_size <= piece) {
+        str->reserve(max_size);
+        oraub8 byte_amt = 0;
+        oraub8 char_amt = len;
+        if (checkerr(OCILobRead2(svchp, errhp, lobp, &byte_amt, &char_amt, 1, (void*)str->getBuffer(), max_size,
+            OCI_ONE_PIECE, 0, 0, (ub2)charsetid, SQLCS_IMPLICIT), "QoreOracleConnection::readClob()", xsink))
+            return nullptr;
+        str->terminate(byte_amt);
+        return str.release();
+    }
+
+    // reserve one byte per character, which is exact for single-byte data; the buffer is only extended if
+    // multi-byte characters are returned
+    oraub8 capacity = len;
+    if (str->reserve(capacity)) {
+        xsink->outOfMemory();
+        return nullptr;
+    }
+
+    oraub8 offset = 0;
+    oraub8 byte_amt = 0;
+    oraub8 char_amt = len;
+    ub1 mode = OCI_FIRST_PIECE;
+    while (true) {
+        if (capacity - offset < piece && capacity < max_size) {
+            capacity = capacity * 2 > offset + piece ? capacity * 2 : offset + piece;
+            if (capacity > max_size)
+                capacity = max_size;
+            if (str->reserve(capacity)) {
+                OCIBreak(svchp, errhp);
+                xsink->outOfMemory();
+                return nullptr;
+            }
+        }
+        oraub8 bufl = capacity - offset;
+        if (bufl > piece)
+            bufl = piece;
+        sword rc = OCILobRead2(svchp, errhp, lobp, &byte_amt, &char_amt, 1, (char*)str->getBuffer() + offset, bufl,
+            mode, 0, 0, (ub2)charsetid, SQLCS_IMPLICIT);
+        if (rc != OCI_NEED_DATA && checkerr(rc, "QoreOracleConnection::readClob()", xsink))
+            return nullptr;
+        offset += byte_amt;
+        if (rc != OCI_NEED_DATA)
+            break;
+        if (offset >= max_size) {
+            // cannot happen unless the LOB was changed while it was being read
+            OCIBreak(svchp, errhp);
+            xsink->raiseException("DBI:ORACLE:LOB-ERROR", "QoreOracleConnection::readClob(): CLOB data exceeds "
+                "the length returned by the server (" QLLD " characters)", (int64)len);
+            return nullptr;
+        }
+        mode = OCI_NEXT_PIECE;
+    }
+    str->terminate(offset);
+    return str.release();
+#else
+    return readClobStream(lobp, enc, xsink);
+#endif
+}
+
+QoreStringNode* QoreOracleConnection::readClobStream(OCILobLocator* lobp, const QoreEncoding* enc,
+        ExceptionSink* xsink) {
     void *dbuf = malloc(LOB_BLOCK_SIZE);
     ON_BLOCK_EXIT(free, dbuf);
     ub4 amt = 0;
@@ -509,19 +1242,20 @@ QoreStringNode *QoreOracleConnection::readClob(OCILobLocator *lobp, const QoreEn
 int QoreOracleConnection::writeLob(OCILobLocator* lobp, void* bufp, oraub8 buflen, bool clob, const char* desc, ExceptionSink* xsink) {
 #ifdef HAVE_OCILOBWRITE2
     oraub8 amtp = buflen;
-    if (buflen <= LOB_BLOCK_SIZE)
+    if (buflen <= LOB_ONE_PIECE_MAX)
         return checkerr(OCILobWrite2(svchp, errhp, lobp, &amtp, 0, 1, bufp, buflen, OCI_ONE_PIECE, 0, 0, charsetid, SQLCS_IMPLICIT), desc, xsink);
 
-    // retrieve *LOB data
-    void* dbuf = malloc(LOB_BLOCK_SIZE);
-    ON_BLOCK_EXIT(free, dbuf);
+    // write pieces aligned to the LOB chunk size directly from the caller's buffer
+    oraub8 piece_size = getLobPieceSize(lobp, 1, xsink);
+    if (!piece_size)
+        return -1;
 
     oraub8 offset = 0;
     while (true) {
         ub1 piece;
         oraub8 len = buflen - offset;
-        if (len > LOB_BLOCK_SIZE) {
-            len = LOB_BLOCK_SIZE;
+        if (len > piece_size) {
+            len = piece_size;
             piece = offset ? OCI_NEXT_PIECE : OCI_FIRST_PIECE;
             //printd(5, "QoreOracleConnection::writeLob() piece = %s\n", offset ? "OCI_NEXT_PIECE" : "OCI_FIRST_PIECE");
         }
@@ -530,10 +1264,7 @@ int QoreOracleConnection::writeLob(OCILobLocator* lobp, void* bufp, oraub8 bufle
             //printd(5, "QoreOracleConnection::writeLob() piece = OCI_LAST_PIECE\n");
         }
 
-        // copy data to buffer
-        memcpy(dbuf, ((char*)bufp) + offset, len);
-
-        sword rc = OCILobWrite2(svchp, errhp, lobp, &amtp, 0, 1, dbuf, len, piece, 0, 0, charsetid, SQLCS_IMPLICIT);
+        sword rc = OCILobWrite2(svchp, errhp, lobp, &amtp, 0, 1, ((char*)bufp) + offset, len, piece, 0, 0, charsetid, SQLCS_IMPLICIT);
         //printd(5, "QoreOracleConnection::writeLob() offset: "QLLD" len: "QLLD" amtp: "QLLD" total: "QLLD" rc: %d\n", offset, len, amtp, buflen, (int)rc);
         if (piece == OCI_LAST_PIECE) {
             if (rc != OCI_SUCCESS) {
@@ -551,19 +1282,20 @@ int QoreOracleConnection::writeLob(OCILobLocator* lobp, void* bufp, oraub8 bufle
     }
 #else
     ub4 amtp = buflen;
-    if (buflen <= LOB_BLOCK_SIZE)
+    if (buflen <= LOB_ONE_PIECE_MAX)
         return checkerr(OCILobWrite(svchp, errhp, lobp, &amtp, 1, bufp, buflen, OCI_ONE_PIECE, 0, 0, charsetid, SQLCS_IMPLICIT), desc, xsink);
 
-    // retrieve *LOB data
-    void* dbuf = malloc(LOB_BLOCK_SIZE);
-    ON_BLOCK_EXIT(free, dbuf);
+    // write pieces aligned to the LOB chunk size directly from the caller's buffer
+    ub4 piece_size = getLobPieceSize(lobp, 1, xsink);
+    if (!piece_size)
+        return -1;
 
     ub4 offset = 0;
     while (true) {
         ub1 piece;
         ub4 len = buflen - offset;
-        if (len > LOB_BLOCK_SIZE) {
-            len = LOB_BLOCK_SIZE;
+        if (len > piece_size) {
+            len = piece_size;
             piece = offset ? OCI_NEXT_PIECE : OCI_FIRST_PIECE;
             //printd(5, "QoreOracleConnection::writeLob() piece = %s\n", offset ? "OCI_NEXT_PIECE" : "OCI_FIRST_PIECE");
         }
@@ -572,10 +1304,7 @@ int QoreOracleConnection::writeLob(OCILobLocator* lobp, void* bufp, oraub8 bufle
             //printd(5, "QoreOracleConnection::writeLob() piece = OCI_LAST_PIECE\n");
         }
 
-        // copy data to buffer
-        memcpy(dbuf, ((char*)bufp) + offset, len);
-
-        sword rc = OCILobWrite(svchp, errhp, lobp, &amtp, 1, dbuf, len, piece, 0, 0, charsetid, SQLCS_IMPLICIT);
+        sword rc = OCILobWrite(svchp, errhp, lobp, &amtp, 1, ((char*)bufp) + offset, len, piece, 0, 0, charsetid, SQLCS_IMPLICIT);
         //printd(5, "QoreOracleConnection::writeLob() offset: "QLLD" len: "QLLD" amtp: "QLLD" total: "QLLD" rc: %d\n", offset, len, amtp, buflen, (int)rc);
         if (piece == OCI_LAST_PIECE) {
             if (rc != OCI_SUCCESS) {
@@ -39,27 +39,43 @@
 // date format used when creating OCIDateTime values with year < 2 as OCIDateTimeConstruct will fail
 #define ORA_BACKUP_DATE_FMT "YYYYMMDDHH24MISSFF6"
 
+//! a reference to an OCI environment handle shared by all connections with the same character set and mode
 class QoreOracleEnvironment {
 protected:
     OCIEnv* envhp;
+    ub2 charset;
 
 public:
-    DLLLOCAL QoreOracleEnvironment() : envhp(0) {
+    DLLLOCAL QoreOracleEnvironment() : envhp(0), charset(0) {
     }
 
     DLLLOCAL ~QoreOracleEnvironment() {
         if (envhp)
-            OCIHandleFree(envhp, OCI_HTYPE_ENV);
+            release(envhp, charset, QORE_OCI_FLAGS | OCI_NO_UCB);
     }
 
+    //! acquires the shared environment with the client's default character set
     DLLLOCAL int init() {
-        return OCIEnvCreate(&envhp, QORE_OCI_FLAGS | OCI_NO_UCB, 0, 0, 0, 0, 0, 0) == OCI_SUCCESS ? 0 : -1;
+        return init(0);
     }
 
-    DLLLOCAL int init(unsigned short charset) {
-        return OCIEnvNlsCreate(&envhp, QORE_OCI_FLAGS | OCI_NO_UCB, 0, 0, 0, 0, 0, 0, charset, charset) == OCI_SUCCESS ? 0 : -1;
+    //! acquires the shared environment for the given character set ID
+    DLLLOCAL int init(unsigned short n_charset) {
+        assert(!envhp);
+        charset = n_charset;
+        envhp = acquire(charset, QORE_OCI_FLAGS | OCI_NO_UCB);
+        return envhp ? 0 : -1;
     }
 
+    //! frees all shared environments still registered; called when the module is deleted
+    DLLLOCAL static void cleanup();
+
+    //! returns the Oracle character set ID for the given name or 0 if unknown; results are cached process-wide
+    DLLLOCAL static unsigned short lookupCharSetId(const char* name);
+
+    //! maps a character set name in the given direction; returns 0 on success; results are cached process-wide
+    DLLLOCAL static int lookupNameMap(const char* name, QoreString& out, int dir);
+
     DLLLOCAL int nlsNameMapToOracle(const char *name, QoreString &out) {
         return nlsNameMap(name, out, OCI_NLS_CS_IANA_TO_ORA);
     }
@@ -92,6 +108,13 @@ public:
     DLLLOCAL OCIEnv *operator*() const {
         return envhp;
     }
+
+protected:
+    //! returns a new reference to the shared environment for the given character set and mode, creating it if necessary
+    DLLLOCAL static OCIEnv* acquire(ub2 charset, ub4 mode);
+
+    //! releases a reference; the environment is freed when the last connection using it is closed
+    DLLLOCAL static void release(OCIEnv* envhp, ub2 charset, ub4 mode);
 };
 
 #define OPT_NUM_OPTIMAL 0  // return numbers as int64 if it fits or "number" if not
@@ -101,8 +124,55 @@ public:
 // return optimal numeric values if options are supported
 #define OPT_NUM_DEFAULT OPT_NUM_OPTIMAL
 
-// forward reference
+// driver-specific options
+#define ORA_OPT_CURSOR_MODE "cursor-mode"
+#define ORA_OPT_CURSOR_PREFETCH "cursor-prefetch"
+#define ORA_OPT_ZERO_COPY_STRINGS "zero-copy-strings"
+#define ORA_OPT_LOB_PREFETCH_SIZE "lob-prefetch-size"
+#define ORA_OPT_LOB_AS_LONG "lob-as-long"
+#define ORA_OPT_LOB_MODE "lob-mode"
+#define ORA_OPT_LONG_MAX_SIZE "long-max-size"
+#define ORA_OPT_SESSION_POOL "session-pool"
+#define ORA_OPT_SESSION_POOL_MIN "session-pool-min"
+#define ORA_OPT_SESSION_POOL_MAX "session-pool-max"
+#define ORA_OPT_SESSION_POOL_INCREMENT "session-pool-increment"
+#define ORA_OPT_SESSION_POOL_TIMEOUT "session-pool-timeout"
+#define ORA_OPT_STMT_CACHE_SIZE "stmt-cache-size"
+#define ORA_OPT_DRCP "drcp"
+#define ORA_OPT_CONNECTION_CLASS "connection-class"
+#define ORA_OPT_PURITY "purity"
+#define ORA_OPT_SERVER_MULTIPLEX "server-multiplex"
+#define ORA_OPT_CALL_TIMEOUT "call-timeout"
+#define ORA_OPT_CANCEL_KEY "cancel-key"
+#define ORA_OPT_FETCH_AHEAD "fetch-ahead"
+#define ORA_OPT_DECODE_THREADS "decode-threads"
+
+#define OPT_CURSOR_EAGER     0  // nested cursors are fetched immediately and returned as data
+#define OPT_CURSOR_STATEMENT 1  // nested cursors are returned as SQLStatement objects
+
+#define OPT_LOB_VALUE   0  // LOB values are read and returned as strings or binary objects
+#define OPT_LOB_LOCATOR 1  // LOB values are returned as OracleLob objects
+
+// default maximum size of LONG column values
+#define ORA_LONG_MAX_SIZE (10 * 1024 * 1024)
+
+// reasons for interrupting calls
+#define ORA_CALL_TIMEOUT   1  // the call timed out
+#define ORA_CALL_CANCELLED 2  // the call was cancelled from another thread
+
+// default maximum number of sessions in a session pool
+#define ORA_SESSION_POOL_MAX 100
+// default statement cache size for pooled sessions
+#define ORA_STMT_CACHE_SIZE 20
+// maximum number of threads for converting fetched rows
+#define ORA_DECODE_THREADS_MAX 64
+
+// forward references
 class QorePreparedStatement;
+class QoreOracleSessionPool;
+class QoreOracleSharedServer;
+class QoreOracleFetchAhead;
+class OracleLobPriv;
 
 class QoreOracleConnection {
 public:
@@ -124,6 +194,75 @@ public:
 
     QoreString cstr; // connection string
     int number_support;
+    // how nested cursors are returned
+    int cursor_mode = OPT_CURSOR_EAGER;
+    // the prefetch row count for nested cursors fetched eagerly; 0 = use the default bulk prefetch row count
+    int cursor_prefetch = 0;
+    // hand fetch buffers for string columns to the string values instead of copying them
+    bool zero_copy_strings = false;
+    // LOB prefetch size in bytes (BLOB) or characters (CLOB); 0 = no LOB prefetching
+    int lob_prefetch_size = 0;
+    // fetch LOB columns with dynamic defines like LONG columns instead of with locators
+    bool lob_as_long = false;
+    // how LOB values are returned
+    int lob_mode = OPT_LOB_VALUE;
+    // the maximum size of LONG column values in bytes
+    int long_max_size = ORA_LONG_MAX_SIZE;
+    // the session NLS settings have to be set before the first statement is executed
+    bool session_setup_pending = false;
+
+    // the following options are only used when the connection is opened
+    // get sessions from a shared OCI session pool instead of attaching to the server and logging on
+    bool session_pool = false;
+    // the minimum, maximum, and increment number of sessions in the session pool
+    unsigned session_pool_min = 1,
+        session_pool_max = ORA_SESSION_POOL_MAX,
+        session_pool_incr = 1;
+    // the idle timeout in seconds for sessions in the session pool; 0 = no timeout
+    unsigned session_pool_timeout = 0;
+    // the statement cache size for pooled sessions; 0 = no statement caching
+    unsigned stmt_cache_size = ORA_STMT_CACHE_SIZE;
+    // connect to a Database Resident Connection Pooling (DRCP) pooled server
+    bool drcp = false;
+    // the DRCP connection class; empty = none
+    std::string connection_class;
+    // the DRCP session purity
+    ub4 purity = OCI_ATTR_PURITY_DEFAULT;
+    // the maximum number of sessions sharing one server attachment; 0 or 1 = the connection attaches itself
+    unsigned server_multiplex = 0;
+
+    // the call timeout in milliseconds; 0 = no timeout
+    unsigned call_timeout = 0;
+    // true if the call timeout is enforced by the client library with OCI_ATTR_CALL_TIMEOUT, otherwise calls are
+    // interrupted by the call monitor's watchdog thread
+    bool native_call_timeout = false;
+    // the key for cancelling calls from other threads; empty = calls cannot be cancelled
+    std::string cancel_key;
+    // the following are managed by the call monitor
+    // error handle for interrupting calls from other threads
+    OCIError* brk_errhp = nullptr;
+    // true while a monitored call is in progress
+    bool in_call = false;
+    // the reason the last call was interrupted, 0 = not interrupted
+    int call_interrupted = 0;
+    // the deadline of the call in progress in milliseconds, 0 = no deadline
+    int64 call_deadline = 0;
+
+    // fetch the next batch of rows in a helper thread while the rows returned by SQLStatement::fetchRows() are
+    // processed
+    bool fetch_ahead = false;
+    // the following are managed by QoreOracleFetchAhead
+    // the statement fetching rows ahead in a helper thread; only set and cleared in the thread using the connection
+    QoreOracleFetchAhead* fetch_ahead_call = nullptr;
+    // true while rows are fetched ahead in the helper thread
+    bool fetch_ahead_running = false;
+    // the time zone of the thread that started fetching the batch in the helper thread
+    const AbstractQoreZoneInfo* fetch_ahead_zone = nullptr;
+    // true if the connection was lost while fetching rows ahead; handled in the thread using the connection
+    bool fetch_ahead_lost = false;
+
+    // the number of threads converting the rows returned by fetchRows() into hashes; 0 or 1 = no parallel conversion
+    unsigned decode_threads = 0;
 
     DLLLOCAL QoreOracleConnection(Datasource &n_ds, ExceptionSink* xsink);
     DLLLOCAL ~QoreOracleConnection();
@@ -132,6 +271,20 @@ public:
 
     DLLLOCAL bool handleError(ExceptionSink* xsink, const char* who, bool can_retry);
 
+    //! closes statements and reconnects after the connection was lost; returns true if the call can be retried
+    DLLLOCAL bool handleLostConnection(ExceptionSink* xsink, bool can_retry);
+
+    //! returns the time zone for DATE values; rows fetched ahead use the zone of the thread using the connection
+    DLLLOCAL const AbstractQoreZoneInfo* getZone() const {
+        return fetch_ahead_running ? fetch_ahead_zone : currentTZ();
+    }
+
+    //! waits for rows being fetched ahead in a helper thread before the connection is used
+    DLLLOCAL void quiesce() {
+        if (fetch_ahead_call)
+            quiesceIntern();
+    }
+
     DLLLOCAL int doException(const char *query_name, text errbuf[], sb4 errcode, ExceptionSink *xsink);
 
     DLLLOCAL int descriptorAlloc(void **descpp, unsigned type, const char *who, ExceptionSink* xsink);
@@ -140,6 +293,53 @@ public:
 
     DLLLOCAL int logon(ExceptionSink* xsink);
 
+    //! returns true if calls have to be registered with the call monitor
+    /** calls on a shared server attachment are not interrupted, as OCIBreak() would break the calls of the other
+        sessions on the attachment; the call timeout only limits the wait for the attachment
+    */
+    DLLLOCAL bool isCallMonitored() const {
+        return !cancel_key.empty() || (call_timeout && !native_call_timeout && !shared_srv);
+    }
+
+    //! returns the timeout for calls to be enforced by the call monitor
+    DLLLOCAL unsigned getWatchdogTimeout() const {
+        return native_call_timeout || shared_srv ? 0 : call_timeout;
+    }
+
+    //! sets the call timeout on the service context if supported by the client library
+    DLLLOCAL void setCallTimeout();
+
+    //! returns the server attachment shared with other connections or nullptr if the connection attaches itself
+    DLLLOCAL QoreOracleSharedServer* getSharedServer() const {
+        return shared_srv;
+    }
+
+    //! acquires the shared server attachment for the calls of the connection, if any; calls can be nested
+    /** returns -1 if an exception was raised because the call timeout expired while waiting for the attachment
+    */
+    DLLLOCAL int serverCallStart(ExceptionSink* xsink);
+
+    //! releases the shared server attachment when the outermost call ends
+    DLLLOCAL void serverCallEnd();
+
+    //! returns true if statements are prepared from the statement cache of a pooled session
+    DLLLOCAL bool useStmtCache() const {
+        return spool && stmt_cache_size;
+    }
+
+    //! sets up the session NLS settings if not yet done since the last logon
+    /** returns -1 if an exception was raised, otherwise 0 with the OCI status of the setup statement in \a status;
+        an OCI_ERROR status must be handled like an error executing the caller's statement, so that a connection lost
+        while the session was idle is reestablished and the statement is retried
+    */
+    DLLLOCAL int checkSessionSetup(sword& status, ExceptionSink* xsink) {
+        if (!session_setup_pending) {
+            status = OCI_SUCCESS;
+            return 0;
+        }
+        return setupSession(status, xsink);
+    }
+
     DLLLOCAL void clearWarnings() {
         ub4 ix = 1;
         int errcode;
@@ -155,12 +355,27 @@ public:
     DLLLOCAL int logoff() {
         assert(svchp);
 
+        // LOB locators cannot be used after the session has been closed
+        invalidateLobs();
+
         // free all cached typeinfo objects
         if (ocilib_cn)
             clearCache();
 
+        if (spool)
+            return sessionRelease();
+
+        // the session is ended on a shared attachment when no other session is in a call
+        bool hold = shared_srv && !srv_calls;
+        if (hold)
+            shared_srv->callStart(0);
         int rc = OCISessionEnd(svchp, errhp, usrhp, 0);
-        OCIServerDetach(srvhp, errhp, OCI_DEFAULT);
+        if (hold)
+            shared_srv->callEnd();
+        if (shared_srv)
+            releaseSharedServer();
+        else
+            OCIServerDetach(srvhp, errhp, OCI_DEFAULT);
         return rc;
     }
 
@@ -243,12 +458,27 @@ public:
         return new QoreStringNode(version_buf);
     }
 
-    DLLLOCAL BinaryNode *readBlob(OCILobLocator *lobp, ExceptionSink* xsink);
-    DLLLOCAL QoreStringNode *readClob(OCILobLocator *lobp, const QoreEncoding *enc, ExceptionSink* xsink);
+    // length_prefetched: true if the LOB length was returned with the row, so it can be checked without a round trip
+    DLLLOCAL BinaryNode *readBlob(OCILobLocator *lobp, bool length_prefetched, ExceptionSink* xsink);
+    DLLLOCAL QoreStringNode *readClob(OCILobLocator *lobp, const QoreEncoding *enc, bool length_prefetched,
+            ExceptionSink* xsink);
+
+    // returns the buffer size for piecewise LOB I/O as a multiple of the LOB's chunk size, 0 = error
+    DLLLOCAL ub4 getLobPieceSize(OCILobLocator* lobp, unsigned width, ExceptionSink* xsink);
+#ifdef HAVE_OCILOBREAD2
+    // returns true if a LOB value with the given length is in the locator's prefetch cache
+    DLLLOCAL bool isLobPrefetched(oraub8 len) const;
+#endif
+
+    // sets LOB length prefetching and, if enabled, LOB data prefetching on the define handle of a LOB column
+    // returns 1 if the length is prefetched, 0 if not supported by the client library, -1 for errors
+    DLLLOCAL int setLobPrefetch(OCIDefine* defp, ExceptionSink* xsink);
 
     DLLLOCAL int writeLob(OCILobLocator* lobp, void* bufp, oraub8 buflen, bool clob, const char* desc, ExceptionSink* xsink);
 
     DLLLOCAL int setOption(const char* opt, QoreValue val, ExceptionSink* xsink) {
+        if (isConnectOption(opt))
+            return setConnectOption(opt, val, xsink);
         if (!strcasecmp(opt, DBI_OPT_NUMBER_OPT)) {
             number_support = OPT_NUM_OPTIMAL;
             return 0;
@@ -261,6 +491,99 @@ public:
             number_support = OPT_NUM_NUMERIC;
             return 0;
         }
+        if (!strcasecmp(opt, ORA_OPT_CURSOR_MODE)) {
+            assert(val.getType() == NT_STRING);
+            const char* mode = val.get<const QoreStringNode>()->c_str();
+            if (!strcasecmp(mode, "eager")) {
+                cursor_mode = OPT_CURSOR_EAGER;
+            } else if (!strcasecmp(mode, "statement")) {
+                cursor_mode = OPT_CURSOR_STATEMENT;
+            } else {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': '%s'; expecting "
+                    "\"eager\" or \"statement\"", opt, mode);
+                return -1;
+            }
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_CURSOR_PREFETCH)) {
+            int64 rows = val.getAsBigInt();
+            if (rows < 0) {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value "
+                    "must be zero (meaning use the default) or positive", opt, rows);
+                return -1;
+            }
+            cursor_prefetch = (int)rows;
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_ZERO_COPY_STRINGS)) {
+            zero_copy_strings = val.getAsBool();
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_LOB_PREFETCH_SIZE)) {
+            int64 size = val.getAsBigInt();
+            if (size < 0 || size > INT_MAX) {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value "
+                    "must be zero (meaning no LOB prefetching) or a positive size", opt, size);
+                return -1;
+            }
+            lob_prefetch_size = (int)size;
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_LOB_AS_LONG)) {
+            lob_as_long = val.getAsBool();
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_LOB_MODE)) {
+            assert(val.getType() == NT_STRING);
+            const char* mode = val.get<const QoreStringNode>()->c_str();
+            if (!strcasecmp(mode, "value")) {
+                lob_mode = OPT_LOB_VALUE;
+            } else if (!strcasecmp(mode, "locator")) {
+                lob_mode = OPT_LOB_LOCATOR;
+            } else {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': '%s'; expecting "
+                    "\"value\" or \"locator\"", opt, mode);
+                return -1;
+            }
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_LONG_MAX_SIZE)) {
+            int64 size = val.getAsBigInt();
+            if (size <= 0 || size > INT_MAX) {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value "
+                    "must be a positive size in bytes", opt, size);
+                return -1;
+            }
+            long_max_size = (int)size;
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_CALL_TIMEOUT)) {
+            int64 ms = val.getAsBigInt();
+            if (ms < 0 || ms > INT_MAX) {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value "
+                    "must be zero (meaning no timeout) or a positive number of milliseconds", opt, ms);
+                return -1;
+            }
+            call_timeout = (unsigned)ms;
+            setCallTimeout();
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_CANCEL_KEY))
+            return setCancelKey(val, xsink);
+        if (!strcasecmp(opt, ORA_OPT_FETCH_AHEAD)) {
+            fetch_ahead = val.getAsBool();
+            return 0;
+        }
+        if (!strcasecmp(opt, ORA_OPT_DECODE_THREADS)) {
+            int64 threads = val.getAsBigInt();
+            if (threads < 0 || threads > ORA_DECODE_THREADS_MAX) {
+                xsink->raiseException("ORACLE-OPTION-ERROR", "invalid value for option '%s': " QLLD "; the value "
+                    "must be between 0 and %d", opt, threads, ORA_DECODE_THREADS_MAX);
+                return -1;
+            }
+            decode_threads = (unsigned)threads;
+            return 0;
+        }
         if (!strcasecmp(opt, DBI_OPT_TIMEZONE)) {
             assert(val.getType() == NT_STRING);
             const QoreStringNode* str = val.get<const QoreStringNode>();
@@ -284,6 +607,71 @@ public:
         if (!strcasecmp(opt, DBI_OPT_NUMBER_NUMERIC))
             return number_support == OPT_NUM_NUMERIC;
 
+        if (!strcasecmp(opt, ORA_OPT_CURSOR_MODE))
+            return new QoreStringNode(cursor_mode == OPT_CURSOR_EAGER ? "eager" : "statement");
+
+        if (!strcasecmp(opt, ORA_OPT_CURSOR_PREFETCH))
+            return cursor_prefetch;
+
+        if (!strcasecmp(opt, ORA_OPT_ZERO_COPY_STRINGS))
+            return zero_copy_strings;
+
+        if (!strcasecmp(opt, ORA_OPT_LOB_PREFETCH_SIZE))
+            return lob_prefetch_size;
+
+        if (!strcasecmp(opt, ORA_OPT_LOB_AS_LONG))
+            return lob_as_long;
+
+        if (!strcasecmp(opt, ORA_OPT_LOB_MODE))
+            return new QoreStringNode(lob_mode == OPT_LOB_VALUE ? "value" : "locator");
+
+        if (!strcasecmp(opt, ORA_OPT_LONG_MAX_SIZE))
+            return long_max_size;
+
+        if (!strcasecmp(opt, ORA_OPT_SESSION_POOL))
+            return session_pool;
+
+        if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_MIN))
+            return (int64)session_pool_min;
+
+        if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_MAX))
+            return (int64)session_pool_max;
+
+        if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_INCREMENT))
+            return (int64)session_pool_incr;
+
+        if (!strcasecmp(opt, ORA_OPT_SESSION_POOL_TIMEOUT))
+            return (int64)session_pool_timeout;
+
+        if (!strcasecmp(opt, ORA_OPT_STMT_CACHE_SIZE))
+            return (int64)stmt_cache_size;
+
+        if (!strcasecmp(opt, ORA_OPT_DRCP))
+            return drcp;
+
+        if (!strcasecmp(opt, ORA_OPT_SERVER_MULTIPLEX))
+            return (int64)server_multiplex;
+
+        if (!strcasecmp(opt, ORA_OPT_CALL_TIMEOUT))
+            return (int64)call_timeout;
+
+        if (!strcasecmp(opt, ORA_OPT_FETCH_AHEAD))
+            return fetch_ahead;
+
+        if (!strcasecmp(opt, ORA_OPT_DECODE_THREADS))
+            return (int64)decode_threads;
+
+        if (!strcasecmp(opt, ORA_OPT_CANCEL_KEY))
+            return cancel_key.empty() ? QoreValue() : QoreValue(new QoreStringNode(cancel_key.c_str()));
+
+        if (!strcasecmp(opt, ORA_OPT_CONNECTION_CLASS))
+            return connection_class.empty() ? QoreValue() : QoreValue(new QoreStringNode(connection_class.c_str()));
+
+        if (!strcasecmp(opt, ORA_OPT_PURITY))
+            return new QoreStringNode(purity == OCI_ATTR_PURITY_NEW
+                ? "new"
+                : (purity == OCI_ATTR_PURITY_SELF ? "self" : "default"));
+
         assert(!strcasecmp(opt, DBI_OPT_TIMEZONE));
         return new QoreStringNode(tz_get_region_name(server_tz));
     }
@@ -296,6 +684,34 @@ public:
         return number_support;
     }
 
+    DLLLOCAL int getCursorMode() const {
+        return cursor_mode;
+    }
+
+    DLLLOCAL int getCursorPrefetch() const {
+        return cursor_prefetch;
+    }
+
+    DLLLOCAL bool getZeroCopyStrings() const {
+        return zero_copy_strings;
+    }
+
+    DLLLOCAL int getLobPrefetchSize() const {
+        return lob_prefetch_size;
+    }
+
+    DLLLOCAL bool getLobAsLong() const {
+        return lob_as_long;
+    }
+
+    DLLLOCAL int getLobMode() const {
+        return lob_mode;
+    }
+
+    DLLLOCAL int getLongMaxSize() const {
+        return long_max_size;
+    }
+
     DLLLOCAL QoreValue getNumberOptimal(const char* str) const {
         // see if the value can fit in an int
         size_t len = strlen(str);
@@ -363,6 +779,17 @@ public:
         }
     }
 
+    //! registers a LOB locator returned as an OracleLob object; called with OracleLobPriv::registry_lock held
+    DLLLOCAL void registerLob(OracleLobPriv* lob) {
+        assert(lob_set.find(lob) == lob_set.end());
+        lob_set.insert(lob);
+    }
+
+    //! deregisters a LOB locator returned as an OracleLob object; called with OracleLobPriv::registry_lock held
+    DLLLOCAL void deregisterLob(OracleLobPriv* lob) {
+        lob_set.erase(lob);
+    }
+
     DLLLOCAL static void descriptorFree(void *descp, unsigned type) {
         OCIDescriptorFree(descp, type);
     }
@@ -375,6 +802,60 @@ protected:
     typedef std::set<QorePreparedStatement*> stmt_set_t;
     stmt_set_t stmt_set;
 
+    // LOB locators returned as OracleLob objects
+    typedef std::set<OracleLobPriv*> lob_set_t;
+    lob_set_t lob_set;
+
+    // the shared session pool if sessions are pooled
+    QoreOracleSessionPool* spool = nullptr;
+    // authentication info with the DRCP attributes for getting pooled sessions
+    OCIAuthInfo* authp = nullptr;
+    // the server attachment shared with other connections if sessions are multiplexed
+    QoreOracleSharedServer* shared_srv = nullptr;
+    // the number of nested QoreOracleServerCallHelper objects in the thread using the connection; the shared server
+    // attachment is held while this is not zero
+    unsigned srv_calls = 0;
+    // true if the connection to the server was lost
+    bool session_lost = false;
+    // true once the options given when the connection was opened have been processed
+    bool connect_opts_done = false;
+
+    //! returns true if the option can only be set when the connection is opened
+    DLLLOCAL static bool isConnectOption(const char* opt);
+
+    //! sets an option used when the connection is opened; afterwards the value cannot be changed
+    DLLLOCAL int setConnectOption(const char* opt, QoreValue val, ExceptionSink* xsink);
+
+    //! processes the options given for the datasource that are used when the connection is opened
+    DLLLOCAL int processConnectOptions(ExceptionSink* xsink);
+
+    //! sets the DRCP connection class and purity, if set, on the given session or authentication info handle
+    DLLLOCAL int setDrcpAttributes(void* hndlp, ExceptionSink* xsink);
+
+    //! gets a session from the session pool
+    DLLLOCAL int sessionGet(const QoreString& dblink, ExceptionSink* xsink);
+
+    //! returns the session to the session pool; it is dropped if the connection was lost
+    DLLLOCAL int sessionRelease();
+
+    //! releases the session's reference to the shared server attachment
+    DLLLOCAL void releaseSharedServer();
+
+    //! sets the cancel key option
+    DLLLOCAL int setCancelKey(QoreValue val, ExceptionSink* xsink);
+
+    DLLLOCAL void quiesceIntern();
+
+    //! frees all LOB locators returned as OracleLob objects
+    DLLLOCAL void invalidateLobs();
+
+    //! executes the session setup statement; the OCI status of the execution is returned in \a status
+    DLLLOCAL int setupSession(sword& status, ExceptionSink* xsink);
+
+    // reads LOB data in streaming callback mode without getting the length first
+    DLLLOCAL BinaryNode* readBlobStream(OCILobLocator* lobp, ExceptionSink* xsink);
+    DLLLOCAL QoreStringNode* readClobStream(OCILobLocator* lobp, const QoreEncoding* enc, ExceptionSink* xsink);
+
     DLLLOCAL static sb4 readClobCallback(void *sp, CONST dvoid *bufp, ub4 len, ub1 piece) {
         //printd(5, "QoreOracleConnection::readClobCallback(%p, %p, %d, %d)\n", sp, bufp, len, piece);
         (reinterpret_cast<QoreStringNode *>(sp))->concat((char*)bufp, len);
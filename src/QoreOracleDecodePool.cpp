@@ -0,0 +1,233 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleDecodePool.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "oracle.h"
+
+#include <algorithm>
+#include <set>
+
+QoreOracleDecodePool oraDecodePool;
+
+void QoreOracleDecodePool::run(QoreOracleDecodeTask& task, unsigned chunks, unsigned max_threads) {
+    assert(chunks);
+    assert(max_threads);
+    decode_job job(task, chunks, max_threads - 1);
+
+    AutoLocker al(l);
+    // start pool threads as needed; the calling thread also processes chunks
+    while (threads.size() < job.max_helpers && !quit) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &QoreOracleDecodePool::thread_helper, this))
+            break;
+        threads.push_back(thread);
+    }
+    if (!threads.empty() && chunks > 1) {
+        jobs.push_back(&job);
+        cond.broadcast();
+    }
+
+    while (job.next < job.chunks) {
+        unsigned chunk = takeChunk(job);
+        {
+            AutoUnlocker au(&l);
+            task.runChunk(chunk);
+        }
+        ++job.done;
+    }
+
+    // wait for the chunks processed by pool threads
+    while (job.done < job.chunks)
+        done_cond.wait(l);
+}
+
+unsigned QoreOracleDecodePool::takeChunk(decode_job& job) {
+    assert(job.next < job.chunks);
+    unsigned chunk = job.next++;
+    // remove the job from the list when the last chunk has been taken
+    if (job.next == job.chunks) {
+        job_list_t::iterator i = std::find(jobs.begin(), jobs.end(), &job);
+        if (i != jobs.end())
+            jobs.erase(i);
+    }
+    return chunk;
+}
+
+void QoreOracleDecodePool::shutdown() {
+    thread_list_t tl;
+    {
+        AutoLocker al(l);
+        quit = true;
+        cond.broadcast();
+        tl.swap(threads);
+    }
+    for (thread_list_t::iterator i = tl.begin(), e = tl.end(); i != e; ++i)
+        pthread_join(*i, 0);
+}
+
+void QoreOracleDecodePool::run() {
+    // values are created in this thread
+    QoreForeignThreadHelper qfth;
+
+    AutoLocker al(l);
+    while (!quit) {
+        decode_job* job = nullptr;
+        for (job_list_t::iterator i = jobs.begin(), e = jobs.end(); i != e; ++i) {
+            if ((*i)->helpers < (*i)->max_helpers) {
+                job = *i;
+                break;
+            }
+        }
+        if (!job) {
+            cond.wait(l);
+            continue;
+        }
+
+        ++job->helpers;
+        while (job->next < job->chunks) {
+            unsigned chunk = takeChunk(*job);
+            {
+                AutoUnlocker au(&l);
+                job->task.runChunk(chunk);
+            }
+            // the job must not be accessed after the last chunk is done, as the calling thread returns
+            if (++job->done == job->chunks) {
+                done_cond.broadcast();
+                break;
+            }
+        }
+    }
+}
+
+QoreOracleRowDecoder::QoreOracleRowDecoder(OraResultSet& resultset, const AbstractQoreZoneInfo* zone)
+        : resultset(resultset), zone(zone) {
+    std::set<std::string> used;
+    for (clist_t::iterator i = resultset.clist.begin(), e = resultset.clist.end(); i != e; ++i) {
+        std::string name = (*i)->name.c_str();
+        // find a unique name for duplicate columns like QoreOracleStatement::fetchRow()
+        if (used.find(name) != used.end()) {
+            unsigned num = 1;
+            while (true) {
+                QoreStringMaker tmp("%s_%d", (*i)->name.c_str(), num);
+                if (used.find(tmp.c_str()) == used.end()) {
+                    name = tmp.c_str();
+                    break;
+                }
+                ++num;
+            }
+        }
+        used.insert(name);
+        names.push_back(name);
+    }
+}
+
+bool QoreOracleRowDecoder::canDecode(const OraResultSet& resultset) {
+    for (clist_t::const_iterator i = resultset.clist.begin(), e = resultset.clist.end(); i != e; ++i) {
+        if (!(*i)->isRawType())
+            return false;
+    }
+    return true;
+}
+
+void QoreOracleRowDecoder::addRow() {
+    for (clist_t::iterator i = resultset.clist.begin(), e = resultset.clist.end(); i != e; ++i) {
+        OraColumnBuffer* w = *i;
+        raw_value v;
+        v.offset = data.size();
+        v.len = 0;
+        v.null = w->ind == -1;
+        if (!v.null) {
+            const char* p;
+            v.len = w->getRaw(p);
+            data.append(p, v.len);
+        }
+        data.push_back('\0');
+        values.push_back(v);
+    }
+    ++rows;
+}
+
+int QoreOracleRowDecoder::decode(QoreListNode& l, unsigned max_threads, ExceptionSink* xsink) {
+    if (!rows)
+        return 0;
+
+    // split the rows into one chunk per thread, but do not use more threads than useful
+    chunk_rows = (rows + max_threads - 1) / max_threads;
+    if (chunk_rows < ORA_DECODE_CHUNK_ROWS)
+        chunk_rows = ORA_DECODE_CHUNK_ROWS;
+    unsigned chunks = (rows + chunk_rows - 1) / chunk_rows;
+
+    out.assign(rows, nullptr);
+    chunk_xsink.reset(new ExceptionSink[chunks]);
+    if (chunks > 1)
+        oraDecodePool.run(*this, chunks, max_threads);
+    else
+        runChunk(0);
+
+    int rc = 0;
+    for (unsigned i = 0; i < chunks; ++i) {
+        if (chunk_xsink[i]) {
+            xsink->assimilate(chunk_xsink[i]);
+            rc = -1;
+        }
+    }
+
+    // add the rows in the order they were fetched
+    for (row_list_t::iterator i = out.begin(), e = out.end(); i != e; ++i) {
+        if (!*i)
+            continue;
+        if (rc)
+            (*i)->deref(xsink);
+        else
+            l.push(*i, xsink);
+    }
+
+    data.clear();
+    values.clear();
+    out.clear();
+    chunk_xsink.reset();
+    rows = 0;
+    return rc;
+}
+
+void QoreOracleRowDecoder::runChunk(unsigned chunk) {
+    ExceptionSink& xsink = chunk_xsink[chunk];
+    size_t cols = names.size();
+    size_t end = (chunk + 1) * chunk_rows;
+    if (end > rows)
+        end = rows;
+
+    for (size_t r = chunk * chunk_rows; r < end; ++r) {
+        ReferenceHolder<QoreHashNode> h(new QoreHashNode, &xsink);
+        const raw_value* v = &values[r * cols];
+        for (size_t j = 0; j < cols; ++j) {
+            QoreValue n = v[j].null
+                ? QoreValue(null())
+                : resultset.clist[j]->getRawValue(data.data() + v[j].offset, v[j].len, zone);
+            h->setKeyValue(names[j].c_str(), n, &xsink);
+            if (xsink)
+                return;
+        }
+        out[r] = h.release();
+    }
+}
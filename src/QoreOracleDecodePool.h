@@ -0,0 +1,172 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleDecodePool.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef _QORE_ORACLEDECODEPOOL_H
+#define _QORE_ORACLEDECODEPOOL_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+// the number of rows copied before they are converted when all rows are fetched
+#define ORA_DECODE_BATCH_ROWS 4096
+// the minimum number of rows converted by one thread
+#define ORA_DECODE_CHUNK_ROWS 256
+
+class OraResultSet;
+
+//! work split into chunks that can be processed in any order by any thread
+class QoreOracleDecodeTask {
+public:
+    DLLLOCAL virtual ~QoreOracleDecodeTask() {
+    }
+
+    //! processes the given chunk; called once for each chunk
+    DLLLOCAL virtual void runChunk(unsigned chunk) = 0;
+};
+
+//! a pool of threads shared by all connections for converting fetched rows
+/** threads are started when first needed and are kept until the module is deleted
+*/
+class QoreOracleDecodePool {
+public:
+    DLLLOCAL QoreOracleDecodePool() {
+    }
+
+    DLLLOCAL ~QoreOracleDecodePool() {
+        assert(jobs.empty());
+        assert(threads.empty());
+    }
+
+    //! processes all chunks of the task with up to the given number of threads including the calling thread
+    /** returns when all chunks have been processed; if pool threads cannot be started, the remaining chunks are
+        processed in the calling thread
+    */
+    DLLLOCAL void run(QoreOracleDecodeTask& task, unsigned chunks, unsigned max_threads);
+
+    //! stops all pool threads; called when the module is deleted
+    DLLLOCAL void shutdown();
+
+private:
+    struct decode_job {
+        QoreOracleDecodeTask& task;
+        unsigned chunks;
+        //! the number of pool threads that can work on the job
+        unsigned max_helpers;
+        //! the next chunk to process
+        unsigned next = 0;
+        //! the number of chunks processed
+        unsigned done = 0;
+        //! the number of pool threads working on the job
+        unsigned helpers = 0;
+
+        DLLLOCAL decode_job(QoreOracleDecodeTask& task, unsigned chunks, unsigned max_helpers) : task(task),
+                chunks(chunks), max_helpers(max_helpers) {
+        }
+    };
+
+    typedef std::deque<decode_job*> job_list_t;
+    typedef std::vector<pthread_t> thread_list_t;
+
+    QoreThreadLock l;
+    //! signaled when a job is added
+    QoreCondition cond;
+    //! signaled when the last chunk of a job has been processed
+    QoreCondition done_cond;
+    //! jobs with chunks not yet taken
+    job_list_t jobs;
+    thread_list_t threads;
+    bool quit = false;
+
+    //! takes the next chunk of the job; must be called with the lock held
+    DLLLOCAL unsigned takeChunk(decode_job& job);
+
+    DLLLOCAL void run();
+
+    DLLLOCAL static void* thread_helper(void* context) {
+        ((QoreOracleDecodePool*)context)->run();
+        return 0;
+    }
+};
+
+DLLLOCAL extern QoreOracleDecodePool oraDecodePool;
+
+//! copies fetched rows and converts them to hashes in parallel in the decode pool
+/** only result sets where all values can be converted without OCI calls are supported (see canDecode()); the
+    rows are returned in the order they were fetched
+*/
+class QoreOracleRowDecoder : public QoreOracleDecodeTask {
+public:
+    DLLLOCAL QoreOracleRowDecoder(OraResultSet& resultset, const AbstractQoreZoneInfo* zone);
+
+    //! returns true if all columns of the result set can be converted by the decoder
+    DLLLOCAL static bool canDecode(const OraResultSet& resultset);
+
+    //! copies the values of the current row
+    DLLLOCAL void addRow();
+
+    //! returns the number of rows copied and not yet converted
+    DLLLOCAL size_t size() const {
+        return rows;
+    }
+
+    //! converts the rows copied with up to the given number of threads and appends them to the list in order
+    DLLLOCAL int decode(QoreListNode& l, unsigned max_threads, ExceptionSink* xsink);
+
+    DLLLOCAL virtual void runChunk(unsigned chunk);
+
+private:
+    struct raw_value {
+        //! the offset of the data in the buffer
+        size_t offset;
+        size_t len;
+        bool null;
+    };
+
+    typedef std::vector<raw_value> value_list_t;
+    typedef std::vector<std::string> name_list_t;
+    typedef std::vector<QoreHashNode*> row_list_t;
+
+    OraResultSet& resultset;
+    //! unique column names in the same form as returned by QoreOracleStatement::fetchRow()
+    name_list_t names;
+    //! the time zone of the thread using the connection for DATE values
+    const AbstractQoreZoneInfo* zone;
+    //! the data of all values copied; each value is terminated
+    std::string data;
+    //! the values copied by row
+    value_list_t values;
+    size_t rows = 0;
+    //! the number of rows converted in each chunk
+    size_t chunk_rows = 0;
+    //! the converted rows
+    row_list_t out;
+    //! the exceptions raised when converting each chunk
+    std::unique_ptr<ExceptionSink[]> chunk_xsink;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleFetchAhead.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "oracle.h"
+
+int QoreOracleFetchAhead::start(int rows, ExceptionSink* xsink) {
+    AutoLocker al(l);
+    assert(!busy);
+
+    if (!thread_running) {
+        int rc;
+        if ((rc = pthread_create(&thread, NULL, &QoreOracleFetchAhead::thread_helper, this))) {
+            xsink->raiseErrnoException("THREAD-CREATION-FAILURE", rc, "could not create the fetch-ahead thread");
+            return -1;
+        }
+        thread_running = true;
+    }
+
+    batch_rows = rows;
+    // the rows are converted in the context of the thread using the connection
+    pgm = getProgram();
+    zone = currentTZ();
+    pending = busy = true;
+    cond.broadcast();
+    // all other calls on the connection wait for the batch first
+    stmt.conn.fetch_ahead_call = this;
+    return 0;
+}
+
+void QoreOracleFetchAhead::wait() {
+    {
+        AutoLocker al(l);
+        while (busy)
+            cond.wait(l);
+    }
+    if (stmt.conn.fetch_ahead_call == this)
+        stmt.conn.fetch_ahead_call = nullptr;
+}
+
+bool QoreOracleFetchAhead::isPending() {
+    wait();
+    return !buf.empty() || (batch && !batch->empty()) || batch_xsink;
+}
+
+int QoreOracleFetchAhead::collect(ExceptionSink* xsink) {
+    wait();
+
+    if (batch_xsink) {
+        xsink->assimilate(batch_xsink);
+        discard(xsink);
+        // the lost connection is handled in this thread, as all statements on the connection are closed
+        if (stmt.conn.fetch_ahead_lost) {
+            stmt.conn.fetch_ahead_lost = false;
+            stmt.conn.handleLostConnection(xsink, false);
+        }
+        return -1;
+    }
+
+    if (batch) {
+        ConstListIterator i(batch);
+        while (i.next())
+            buf.push_back(i.getValue().get<QoreHashNode>()->hashRefSelf());
+        batch->deref(xsink);
+        batch = nullptr;
+    }
+    return 0;
+}
+
+QoreListNode* QoreOracleFetchAhead::fetchRows(int rows, ExceptionSink* xsink) {
+    if (collect(xsink))
+        return nullptr;
+
+    ReferenceHolder<QoreListNode> rv(new QoreListNode, xsink);
+    while (!buf.empty() && (rows < 0 || rv->size() < (size_t)rows)) {
+        rv->push(buf.front(), xsink);
+        buf.pop_front();
+    }
+
+    // fetch any further rows needed directly; at the end of the data the statement returns an empty list once and
+    // raises an exception when called again
+    if ((rows < 0 || rv->size() < (size_t)rows) && (rv->empty() || !stmt.isFetchComplete())) {
+        ReferenceHolder<QoreListNode> l(stmt.fetchRowsDirect(rows < 0 ? -1 : rows - (int)rv->size(), xsink),
+            xsink);
+        if (!l)
+            return nullptr;
+        if (rv->empty())
+            rv = l.release();
+        else
+            rv->merge(*l, xsink);
+    }
+
+    // fetch the next batch of the same size while the rows are processed
+    if (rows > 0 && buf.empty() && !stmt.isFetchComplete() && start(rows, xsink))
+        return nullptr;
+
+    return rv.release();
+}
+
+void QoreOracleFetchAhead::discard(ExceptionSink* xsink) {
+    for (auto& i : buf)
+        i->deref(xsink);
+    buf.clear();
+    if (batch) {
+        batch->deref(xsink);
+        batch = nullptr;
+    }
+    batch_xsink.clear();
+}
+
+void QoreOracleFetchAhead::stop(ExceptionSink* xsink) {
+    wait();
+
+    if (thread_running) {
+        {
+            AutoLocker al(l);
+            quit = true;
+            cond.broadcast();
+        }
+        pthread_join(thread, 0);
+        thread_running = false;
+        quit = false;
+    }
+
+    discard(xsink);
+    stmt.conn.fetch_ahead_lost = false;
+}
+
+void QoreOracleFetchAhead::run() {
+    // the helper thread is registered with Qore, as it creates Qore values
+    QoreForeignThreadHelper qfth;
+
+    AutoLocker al(l);
+    while (true) {
+        while (!pending && !quit)
+            cond.wait(l);
+        if (quit)
+            break;
+
+        pending = false;
+        int rows = batch_rows;
+
+        ExceptionSink xsink;
+        QoreListNode* rv;
+        {
+            AutoUnlocker au(&l);
+            // values such as result set statements are created in the program of the thread using the connection
+            QoreExternalProgramContextHelper pch(&xsink, pgm);
+            if (xsink) {
+                rv = nullptr;
+            } else {
+                // the thread using the connection has returned from the driver, so the shared server attachment is
+                // held directly instead of with QoreOracleServerCallHelper
+                QoreOracleSharedServer* srv = stmt.conn.getSharedServer();
+                if (srv)
+                    srv->callStart(0);
+                stmt.conn.fetch_ahead_zone = zone;
+                stmt.conn.fetch_ahead_running = true;
+                rv = stmt.fetchRowsDirect(rows, &xsink);
+                stmt.conn.fetch_ahead_running = false;
+                if (srv)
+                    srv->callEnd();
+            }
+        }
+
+        batch = rv;
+        if (xsink)
+            batch_xsink.assimilate(xsink);
+        busy = false;
+        cond.broadcast();
+    }
+}
@@ -0,0 +1,105 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleFetchAhead.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_ORACLEFETCHAHEAD_H
+#define _QORE_ORACLEFETCHAHEAD_H
+
+#include <deque>
+
+#include <pthread.h>
+
+class QorePreparedStatement;
+
+//! fetches the next batch of rows of a statement in a helper thread while the last batch is processed
+/** only one batch is fetched ahead; the helper thread uses the connection only while the thread using the
+    connection waits in SQLStatement::fetchRows() or has returned from the driver, and all other calls on the
+    connection wait for the batch in progress first (see QoreOracleConnection::quiesce())
+*/
+class QoreOracleFetchAhead {
+public:
+    DLLLOCAL QoreOracleFetchAhead(QorePreparedStatement& stmt) : stmt(stmt) {
+    }
+
+    DLLLOCAL ~QoreOracleFetchAhead() {
+        assert(!thread_running);
+        assert(!batch);
+        assert(buf.empty());
+    }
+
+    //! returns up to the given number of rows (-1 = all rows) and starts fetching the next batch
+    /** rows fetched ahead are returned first, further rows are fetched directly
+    */
+    DLLLOCAL QoreListNode* fetchRows(int rows, ExceptionSink* xsink);
+
+    //! waits for the batch being fetched in the helper thread; the rows are kept for the next call to fetchRows()
+    DLLLOCAL void wait();
+
+    //! returns true if rows have been fetched ahead that were not returned yet
+    DLLLOCAL bool isPending();
+
+    //! stops the helper thread and discards all rows fetched ahead
+    DLLLOCAL void stop(ExceptionSink* xsink);
+
+private:
+    typedef std::deque<QoreHashNode*> row_list_t;
+
+    QorePreparedStatement& stmt;
+    QoreThreadLock l;
+    QoreCondition cond;
+    pthread_t thread;
+    //! rows fetched ahead and not yet returned
+    row_list_t buf;
+    //! the batch fetched by the helper thread
+    QoreListNode* batch = nullptr;
+    //! the exception raised when fetching the batch
+    ExceptionSink batch_xsink;
+    //! the number of rows to fetch in the batch
+    int batch_rows = 0;
+    //! the program and time zone of the thread that started the batch
+    QoreProgram* pgm = nullptr;
+    const AbstractQoreZoneInfo* zone = nullptr;
+    bool thread_running = false,
+        quit = false,
+        //! true if a batch has been requested and not yet taken by the helper thread
+        pending = false,
+        //! true if a batch has been requested or is being fetched
+        busy = false;
+
+    //! starts fetching the next batch in the helper thread
+    DLLLOCAL int start(int rows, ExceptionSink* xsink);
+
+    //! waits for the batch and moves the rows to the buffer; raises the exception of the batch, if any
+    DLLLOCAL int collect(ExceptionSink* xsink);
+
+    //! discards all rows fetched ahead
+    DLLLOCAL void discard(ExceptionSink* xsink);
+
+    DLLLOCAL void run();
+
+    DLLLOCAL static void* thread_helper(void* context) {
+        ((QoreOracleFetchAhead*)context)->run();
+        return 0;
+    }
+};
+
+#endif
@@ -0,0 +1,139 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleSessionPool.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "oracle.h"
+
+#include <map>
+#include <memory>
+
+// shared session pools keyed by login and pool options
+typedef std::map<std::string, QoreOracleSessionPool*> ora_spool_map_t;
+static ora_spool_map_t ora_spool_map;
+static QoreThreadLock ora_spool_lck;
+
+QoreOracleSessionPool* QoreOracleSessionPool::get(QoreOracleConnection& conn, const QoreString& dblink,
+        ExceptionSink* xsink) {
+    if (!conn.session_pool_max || conn.session_pool_min > conn.session_pool_max || !conn.session_pool_incr) {
+        xsink->raiseException("ORACLE-OPTION-ERROR", "invalid session pool options: '" ORA_OPT_SESSION_POOL_MIN
+            "' (%d) must not be greater than '" ORA_OPT_SESSION_POOL_MAX "' (%d), and '" ORA_OPT_SESSION_POOL_MAX
+            "' and '" ORA_OPT_SESSION_POOL_INCREMENT "' (%d) must be positive", conn.session_pool_min,
+            conn.session_pool_max, conn.session_pool_incr);
+        return nullptr;
+    }
+
+    QoreString k;
+    k.sprintf("%d:%d:%d:%d:%d:%d:", (int)conn.charsetid, conn.session_pool_min, conn.session_pool_max,
+        conn.session_pool_incr, conn.session_pool_timeout, conn.stmt_cache_size);
+    std::string key(k.c_str());
+    key += conn.ds.getUsernameStr();
+    key += '\0';
+    key += conn.ds.getPasswordStr();
+    key += '\0';
+    key += dblink.c_str();
+
+    AutoLocker al(ora_spool_lck);
+
+    ora_spool_map_t::iterator i = ora_spool_map.find(key);
+    if (i != ora_spool_map.end()) {
+        ++i->second->refs;
+        return i->second;
+    }
+
+    std::unique_ptr<QoreOracleSessionPool> pool(new QoreOracleSessionPool(key));
+    if (pool->create(conn, dblink, xsink))
+        return nullptr;
+
+    ora_spool_map[key] = pool.get();
+    return pool.release();
+}
+
+void QoreOracleSessionPool::deref() {
+    AutoLocker al(ora_spool_lck);
+    assert(refs);
+    if (--refs)
+        return;
+    ora_spool_map.erase(key);
+    delete this;
+}
+
+QoreOracleSessionPool::~QoreOracleSessionPool() {
+    if (created)
+        OCISessionPoolDestroy(spoolhp, errhp, OCI_DEFAULT);
+    if (spoolhp)
+        OCIHandleFree(spoolhp, OCI_HTYPE_SPOOL);
+    if (errhp)
+        OCIHandleFree(errhp, OCI_HTYPE_ERROR);
+}
+
+int QoreOracleSessionPool::create(QoreOracleConnection& conn, const QoreString& dblink, ExceptionSink* xsink) {
+    if (env.init(conn.charsetid)) {
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "error creating new environment handle with encoding '%s'",
+            conn.ds.getDBEncoding());
+        return -1;
+    }
+
+    if (OCIHandleAlloc(*env, (dvoid**)&errhp, OCI_HTYPE_ERROR, 0, 0) != OCI_SUCCESS) {
+        errhp = nullptr;
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate error handle for session pool");
+        return -1;
+    }
+
+    if (OCIHandleAlloc(*env, (dvoid**)&spoolhp, OCI_HTYPE_SPOOL, 0, 0) != OCI_SUCCESS) {
+        spoolhp = nullptr;
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate session pool handle");
+        return -1;
+    }
+
+    const std::string& user = conn.ds.getUsernameStr();
+    const std::string& pass = conn.ds.getPasswordStr();
+
+    // all sessions in the pool are created with the same login, which allows sessions to be created and reused
+    // without passing credentials for every session
+    ub4 mode = OCI_SPC_HOMOGENEOUS;
+    if (conn.stmt_cache_size)
+        mode |= OCI_SPC_STMTCACHE;
+
+    if (conn.checkerr(OCISessionPoolCreate(*env, conn.errhp, spoolhp, &name, &name_len,
+        (const OraText*)dblink.c_str(), dblink.size(), conn.session_pool_min, conn.session_pool_max,
+        conn.session_pool_incr, (OraText*)user.c_str(), user.size(), (OraText*)pass.c_str(), pass.size(), mode),
+        "QoreOracleSessionPool::create()", xsink))
+        return -1;
+    created = true;
+
+    if (conn.session_pool_timeout) {
+        ub4 timeout = conn.session_pool_timeout;
+        if (conn.checkerr(OCIAttrSet(spoolhp, OCI_HTYPE_SPOOL, &timeout, 0, OCI_ATTR_SPOOL_TIMEOUT, conn.errhp),
+            "QoreOracleSessionPool::create() set idle timeout", xsink))
+            return -1;
+    }
+
+    if (conn.stmt_cache_size) {
+        ub4 size = conn.stmt_cache_size;
+        if (conn.checkerr(OCIAttrSet(spoolhp, OCI_HTYPE_SPOOL, &size, 0, OCI_ATTR_SPOOL_STMTCACHESIZE,
+            conn.errhp), "QoreOracleSessionPool::create() set statement cache size", xsink))
+            return -1;
+    }
+
+    //printd(5, "QoreOracleSessionPool::create() created pool %s for %s@%s\n", name, user.c_str(), dblink.c_str());
+    return 0;
+}
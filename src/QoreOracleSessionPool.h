@@ -0,0 +1,68 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleSessionPool.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef _QORE_ORACLESESSIONPOOL_H
+#define _QORE_ORACLESESSIONPOOL_H
+
+#include <string>
+
+//! an OCI session pool shared by all connections with the same login and pool options
+class QoreOracleSessionPool {
+public:
+    //! returns a reference to the shared pool for the connection, creating it if necessary
+    DLLLOCAL static QoreOracleSessionPool* get(QoreOracleConnection& conn, const QoreString& dblink,
+            ExceptionSink* xsink);
+
+    //! releases a reference; the pool is destroyed when the last connection using it is closed
+    DLLLOCAL void deref();
+
+    DLLLOCAL const OraText* getName() const {
+        return name;
+    }
+
+    DLLLOCAL ub4 getNameLen() const {
+        return name_len;
+    }
+
+private:
+    QoreOracleEnvironment env;
+    // error handle for destroying the pool
+    OCIError* errhp = nullptr;
+    OCISPool* spoolhp = nullptr;
+    // the pool name to get sessions with
+    OraText* name = nullptr;
+    ub4 name_len = 0;
+    // the key in the pool registry
+    std::string key;
+    unsigned refs = 1;
+    bool created = false;
+
+    DLLLOCAL QoreOracleSessionPool(const std::string& key) : key(key) {
+    }
+
+    DLLLOCAL ~QoreOracleSessionPool();
+
+    DLLLOCAL int create(QoreOracleConnection& conn, const QoreString& dblink, ExceptionSink* xsink);
+};
+
+#endif
@@ -0,0 +1,143 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleSharedServer.cpp
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "oracle.h"
+
+#include <map>
+#include <memory>
+
+// shared server attachments keyed by character set and connect string
+typedef std::multimap<std::string, QoreOracleSharedServer*> ora_srv_map_t;
+static ora_srv_map_t ora_srv_map;
+static QoreThreadLock ora_srv_lck;
+
+QoreOracleSharedServer* QoreOracleSharedServer::get(QoreOracleConnection& conn, const QoreString& dblink,
+        unsigned max_sessions, ExceptionSink* xsink) {
+    QoreString k;
+    k.sprintf("%d:", (int)conn.charsetid);
+    std::string key(k.c_str());
+    key += dblink.c_str();
+
+    AutoLocker al(ora_srv_lck);
+
+    for (ora_srv_map_t::iterator i = ora_srv_map.lower_bound(key), e = ora_srv_map.upper_bound(key); i != e; ++i) {
+        QoreOracleSharedServer* srv = i->second;
+        if (!srv->broken && srv->sessions < max_sessions) {
+            ++srv->sessions;
+            return srv;
+        }
+    }
+
+    std::unique_ptr<QoreOracleSharedServer> srv(new QoreOracleSharedServer(key));
+    if (srv->attach(conn, dblink, xsink))
+        return nullptr;
+
+    ora_srv_map.insert(ora_srv_map_t::value_type(key, srv.get()));
+    return srv.release();
+}
+
+void QoreOracleSharedServer::release(bool lost) {
+    AutoLocker al(ora_srv_lck);
+    assert(sessions);
+    if (lost)
+        broken = true;
+    if (--sessions)
+        return;
+
+    for (ora_srv_map_t::iterator i = ora_srv_map.lower_bound(key), e = ora_srv_map.upper_bound(key); i != e; ++i) {
+        if (i->second == this) {
+            ora_srv_map.erase(i);
+            break;
+        }
+    }
+    delete this;
+}
+
+QoreOracleSharedServer::~QoreOracleSharedServer() {
+    if (attached)
+        OCIServerDetach(srvhp, errhp, OCI_DEFAULT);
+    if (srvhp)
+        OCIHandleFree(srvhp, OCI_HTYPE_SERVER);
+    if (errhp)
+        OCIHandleFree(errhp, OCI_HTYPE_ERROR);
+}
+
+int QoreOracleSharedServer::callStart(unsigned timeout_ms) {
+    AutoLocker al(call_lck);
+    if (in_call) {
+        int64 deadline = timeout_ms ? q_clock_getmillis() + timeout_ms : 0;
+        ++call_waiting;
+        while (in_call) {
+            if (!deadline) {
+                call_cond.wait(call_lck);
+                continue;
+            }
+            int64 now = q_clock_getmillis();
+            if (now >= deadline) {
+                --call_waiting;
+                return -1;
+            }
+            call_cond.wait(call_lck, (int)(deadline - now));
+        }
+        --call_waiting;
+    }
+    in_call = true;
+    return 0;
+}
+
+void QoreOracleSharedServer::callEnd() {
+    AutoLocker al(call_lck);
+    assert(in_call);
+    in_call = false;
+    if (call_waiting)
+        call_cond.signal();
+}
+
+int QoreOracleSharedServer::attach(QoreOracleConnection& conn, const QoreString& dblink, ExceptionSink* xsink) {
+    if (env.init(conn.charsetid)) {
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "error creating new environment handle with encoding '%s'",
+            conn.ds.getDBEncoding());
+        return -1;
+    }
+
+    if (OCIHandleAlloc(*env, (dvoid**)&errhp, OCI_HTYPE_ERROR, 0, 0) != OCI_SUCCESS) {
+        errhp = nullptr;
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate error handle for shared server");
+        return -1;
+    }
+
+    if (OCIHandleAlloc(*env, (dvoid**)&srvhp, OCI_HTYPE_SERVER, 0, 0) != OCI_SUCCESS) {
+        srvhp = nullptr;
+        xsink->raiseException("DBI:ORACLE:OPEN-ERROR", "failed to allocate server handle for shared server");
+        return -1;
+    }
+
+    if (conn.checkerr(OCIServerAttach(srvhp, conn.errhp, (text*)dblink.c_str(), dblink.size(), OCI_DEFAULT),
+        "QoreOracleSharedServer::attach()", xsink))
+        return -1;
+    attached = true;
+
+    //printd(5, "QoreOracleSharedServer::attach() attached srvhp: %p to %s\n", srvhp, dblink.c_str());
+    return 0;
+}
@@ -0,0 +1,121 @@
+/* -*- mode: c++; indent-tabs-mode: nil -*- */
+/*
+  QoreOracleSharedServer.h
+
+  Qore Programming Language
+
+  Copyright (C) 2003 - 2022 Qore Technologies, s.r.o.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef _QORE_ORACLESHAREDSERVER_H
+#define _QORE_ORACLESHAREDSERVER_H
+
+#include <string>
+
+//! a server attachment shared by the sessions of several connections
+/** only one call can be in progress on the attachment at a time; every round trip of a session is made while the
+    attachment is held with callStart() and callEnd() (see QoreOracleServerCallHelper), so a session waits while
+    another session sharing the attachment is in a call
+*/
+class QoreOracleSharedServer {
+public:
+    //! returns an attachment to the server for the connection with fewer than the given number of sessions
+    /** a new attachment is made if all existing ones are in use by the maximum number of sessions
+    */
+    DLLLOCAL static QoreOracleSharedServer* get(QoreOracleConnection& conn, const QoreString& dblink,
+            unsigned max_sessions, ExceptionSink* xsink);
+
+    //! releases a session; the server is detached when the last session using it is released
+    /** @param lost true if the connection to the server was lost; no more sessions are added to the attachment
+    */
+    DLLLOCAL void release(bool lost);
+
+    DLLLOCAL OCIServer* getServer() const {
+        return srvhp;
+    }
+
+    //! waits until no other session is in a call on the attachment and registers the start of a call
+    /** @param timeout_ms the maximum time to wait in milliseconds; 0 = wait indefinitely
+
+        @return 0 if the call can be made, -1 if the timeout expired
+    */
+    DLLLOCAL int callStart(unsigned timeout_ms);
+
+    //! registers the end of a call and wakes up a session waiting to make a call
+    DLLLOCAL void callEnd();
+
+private:
+    QoreOracleEnvironment env;
+    // error handle for detaching from the server
+    OCIError* errhp = nullptr;
+    OCIServer* srvhp = nullptr;
+    // the key in the attachment registry
+    std::string key;
+    // the number of sessions using the attachment
+    unsigned sessions = 1;
+    bool attached = false;
+    // true if the connection was lost
+    bool broken = false;
+
+    // serializes calls on the attachment
+    QoreThreadLock call_lck;
+    QoreCondition call_cond;
+    // true while a session is in a call on the attachment
+    bool in_call = false;
+    // the number of sessions waiting to make a call
+    unsigned call_waiting = 0;
+
+    DLLLOCAL QoreOracleSharedServer(const std::string& key) : key(key) {
+    }
+
+    DLLLOCAL ~QoreOracleSharedServer();
+
+    DLLLOCAL int attach(QoreOracleConnection& conn, const QoreString& dblink, ExceptionSink* xsink);
+};
+
+//! holds the shared server attachment of a connection, if any, for all calls made in its scope
+/** used in each DBI entry point and wherever else the connection is used for server round trips; waits for rows
+    being fetched ahead first (see QoreOracleConnection::quiesce())
+*/
+class QoreOracleServerCallHelper {
+public:
+    DLLLOCAL QoreOracleServerCallHelper(QoreOracleConnection& conn, ExceptionSink* xsink) : ds(conn.ds) {
+        conn.quiesce();
+        rc = conn.serverCallStart(xsink);
+    }
+
+    DLLLOCAL ~QoreOracleServerCallHelper() {
+        if (rc)
+            return;
+        // the connection is deleted if it is aborted when handling an error; the attachment was released then
+        QoreOracleConnection* conn = (QoreOracleConnection*)ds.getPrivateData();
+        if (conn)
+            conn->serverCallEnd();
+    }
+
+    //! returns 0 if the calls can be made or -1 if an exception was raised
+    DLLLOCAL int check() const {
+        return rc;
+    }
+
+private:
+    Datasource& ds;
+    int rc;
+};
+
+#endif
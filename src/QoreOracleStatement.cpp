@@ -31,7 +31,7 @@ int QoreOracleStatement::setupDateDescriptor(OCIDateTime*& odt, ExceptionSink* x
 }
 
 int QoreOracleStatement::setPrefetch(ExceptionSink* xsink, int rows) {
-    unsigned prefetch = rows < 0 ? PREFETCH_BULK : (rows ? rows : PREFETCH_DEFAULT);
+    unsigned prefetch = rows < 0 ? bulk_prefetch : (rows ? rows : PREFETCH_DEFAULT);
     if (prefetch > PREFETCH_MAX)
         prefetch = PREFETCH_MAX;
     if (prefetch == prefetch_rows)
@@ -63,41 +63,60 @@ int QoreOracleSimpleStatement::exec(const char* sql, unsigned len, ExceptionSink
         "QoreOracleSimpleStatement::exec", xsink);
 }
 
-QoreHashNode* QoreOracleStatement::fetchRow(OraResultSet& resultset, ExceptionSink* xsink) {
+QoreHashNode* QoreOracleStatement::fetchRow(OraResultSet& resultset, ExceptionSink* xsink, OraLobBatch* lobs) {
     if (!fetch_done) {
         xsink->raiseException("ORACLE-FETCH-ROW-ERROR", "call SQLStatement::next() before calling "
             "SQLStatement::fetchRow()");
         return nullptr;
     }
 
+    // read all LOB values of the row together
+    if (!lobs && resultset.readLobs(xsink))
+        return nullptr;
+
     // set up hash for row
     ReferenceHolder<QoreHashNode> h(new QoreHashNode, xsink);
 
+    // the key of a duplicate column
+    QoreString dup_key;
+
     // copy data or perform per-value processing if needed
     for (clist_t::iterator i = resultset.clist.begin(), e = resultset.clist.end(); i != e; ++i) {
         OraColumnBuffer *w = *i;
+        // LOB values read with the batch are assigned when the batch is read; NULL is assigned until then, so that
+        // the key is taken
+        int batched = lobs ? lobs->add(w, xsink) : 0;
+        if (batched < 0) {
+            return nullptr;
+        }
         // assign value to hash
-        QoreValue n = w->getValue(true, xsink);
+        QoreValue n = batched ? QoreValue(null()) : w->getValue(true, xsink);
         if (*xsink) {
             assert(!n);
             return nullptr;
         }
         HashAssignmentHelper hah(**h, w->name.c_str());
+        const char* key = w->name.c_str();
         // if we have a duplicate column
         if (!hah.get().isNothing()) {
             // find a unique column name
             unsigned num = 1;
             while (true) {
-                QoreStringMaker tmp("%s_%d", w->name.c_str(), num);
-                hah.reassign(tmp.c_str());
+                dup_key.clear();
+                dup_key.sprintf("%s_%d", w->name.c_str(), num);
+                hah.reassign(dup_key.c_str());
                 if (!hah.get().isNothing()) {
                     ++num;
                     continue;
                 }
+                key = dup_key.c_str();
                 break;
             }
         }
 
+        if (batched) {
+            lobs->setTarget(*h, key);
+        }
         hah.assign(n, xsink);
         if (*xsink) {
             return nullptr;
@@ -140,17 +159,48 @@ QoreListNode* QoreOracleStatement::fetchRows(OraResultSet& resultset, int rows,
     }
 
     // now finally fetch the data
-    while (next(xsink)) {
-        QoreHashNode* h = fetchRow(resultset, xsink);
-        if (!h) {
+    unsigned decode_threads = getData()->decode_threads;
+    if (decode_threads > 1 && rows != 1 && QoreOracleRowDecoder::canDecode(resultset)) {
+        // copy the rows and convert them in parallel in batches
+        QoreOracleRowDecoder decoder(resultset, getData()->getZone());
+        size_t batch_rows = rows > 0 && rows < ORA_DECODE_BATCH_ROWS ? rows : ORA_DECODE_BATCH_ROWS;
+        size_t count = 0;
+        while (next(xsink)) {
+            decoder.addRow();
+            if (decoder.size() == batch_rows && decoder.decode(**l, decode_threads, xsink)) {
+                return nullptr;
+            }
+
+            if (rows > 0 && ++count == static_cast<size_t>(rows)) {
+                break;
+            }
+        }
+        if (*xsink || decoder.decode(**l, decode_threads, xsink)) {
             return nullptr;
         }
+    } else {
+        // read the LOB values of several rows with one round trip
+        OraLobBatch lobs(*this);
+        OraLobBatch* lobsp = resultset.canBatchLobs() ? &lobs : nullptr;
+        while (next(xsink)) {
+            QoreHashNode* h = fetchRow(resultset, xsink, lobsp);
+            if (!h) {
+                return nullptr;
+            }
 
-        // add row to list
-        l->push(h, xsink);
+            // add row to list
+            l->push(h, xsink);
 
-        if (rows > 0 && l->size() == static_cast<size_t>(rows)) {
-            break;
+            if (lobs.size() >= LOB_ARRAY_READ_MAX && lobs.read(xsink)) {
+                return nullptr;
+            }
+
+            if (rows > 0 && l->size() == static_cast<size_t>(rows)) {
+                break;
+            }
+        }
+        if (!*xsink && lobs.read(xsink)) {
+            return nullptr;
         }
     }
     //printd(2, "QoreOracleStatement::fetchRows(): %d column(s), %d row(s) retrieved as output\n", resultset.size(),
@@ -172,7 +222,7 @@ QoreHashNode* QoreOracleStatement::fetchSingleRow(ExceptionSink* xsink) {
     if (*xsink)
         return nullptr;
 
-    if (setPrefetch(xsink))
+    if (setPrefetch(xsink, PREFETCH_SINGLE_ROW))
         return nullptr;
 
     ReferenceHolder<QoreHashNode> rv(xsink);
@@ -257,6 +307,10 @@ QoreHashNode* QoreOracleStatement::fetchColumns(OraResultSet& resultset, int row
         if (h->empty())
             doColumns(resultset, **h);
 
+        // read all LOB values of the row together
+        if (resultset.readLobs(xsink))
+            break;
+
         // copy data or perform per-value processing if needed
         for (unsigned i = 0; i < resultset.clist.size(); ++i) {
             OraColumnBuffer* w = resultset.clist[i];
@@ -32,17 +32,24 @@
 #include <oci.h>
 
 class OraResultSet;
+class OraLobBatch;
 
 // default prefetch row count
 #define PREFETCH_DEFAULT 1
+// prefetch row count for single-row selects (one more than needed to detect more than one row)
+#define PREFETCH_SINGLE_ROW 2
 // default prefetch row count for fetching all rows (fetchRows(-1) or fetchColumns(-1))
 #define PREFETCH_BULK 1000
 // maximum prefetch row count
 #define PREFETCH_MAX 32767
+// prefetch row count of a cached statement handle is unknown (never matches a requested prefetch row count)
+#define PREFETCH_UNKNOWN 0
 
 struct QoreOracleSimpleStatement {
     QoreOracleConnection& conn;
     OCIStmt* stmthp;
+    // true if the handle was prepared from the session's statement cache
+    bool cached = false;
 
     DLLLOCAL QoreOracleSimpleStatement(QoreOracleConnection& n_conn, OCIStmt* n_stmthp = nullptr) : conn(n_conn),
         stmthp(n_stmthp) {
@@ -56,13 +63,30 @@ struct QoreOracleSimpleStatement {
 
     DLLLOCAL void del() {
         assert(stmthp);
+        if (cached) {
+            // return the handle to the session's statement cache
+            OCIStmtRelease(stmthp, conn.errhp, 0, 0, OCI_DEFAULT);
+            cached = false;
+            return;
+        }
         // free OCI handle
         OCIHandleFree(stmthp, OCI_HTYPE_STMT);
     }
 
+    // releases the statement handle without freeing it; used for handles owned by another statement
+    DLLLOCAL OCIStmt* release() {
+        OCIStmt* rv = stmthp;
+        stmthp = nullptr;
+        return rv;
+    }
+
     DLLLOCAL int allocate(ExceptionSink* xsink) {
         assert(!stmthp);
 
+        // with statement caching the handle is taken from the cache when the statement is prepared
+        if (conn.useStmtCache())
+            return 0;
+
         if (conn.handleAlloc((dvoid**)&stmthp, OCI_HTYPE_STMT, "QoreOracleSimpleStatement::allocate()", xsink)) {
             stmthp = nullptr;
             return -1;
@@ -76,6 +100,16 @@ struct QoreOracleSimpleStatement {
     }
 
     DLLLOCAL int prepare(const char* sql, unsigned len, ExceptionSink* xsink) {
+        if (!stmthp) {
+            assert(conn.useStmtCache());
+            if (conn.checkerr(OCIStmtPrepare2(conn.svchp, &stmthp, conn.errhp, (text*)sql, len, 0, 0, OCI_NTV_SYNTAX,
+                OCI_DEFAULT), "QoreOracleSimpleStatement::prepare()", xsink)) {
+                stmthp = nullptr;
+                return -1;
+            }
+            cached = true;
+            return 0;
+        }
         return conn.checkerr(OCIStmtPrepare(stmthp, conn.errhp, (text*)sql, len, OCI_NTV_SYNTAX, OCI_DEFAULT),
             "QoreOracleSimpleStatement::prepare()", xsink);
     }
@@ -88,9 +122,13 @@ protected:
     Datasource* ds;
     // for array binds
     unsigned array_size = 0;
-    // current select prefetch row count
-    unsigned prefetch_rows = 1;
+    // current select prefetch row count; PREFETCH_UNKNOWN for handles taken from the statement cache
+    unsigned prefetch_rows = PREFETCH_DEFAULT;
+    // prefetch row count used when fetching all rows
+    unsigned bulk_prefetch = PREFETCH_BULK;
     bool is_select = false,
+        // true if the statement is an INSERT, UPDATE, DELETE, or MERGE statement
+        is_dml = false,
         fetch_done = false,
         fetch_complete = false,
         fetch_warned = false;
@@ -113,7 +151,11 @@ public:
         }
 
         is_select = false;
+        is_dml = false;
         fetch_done = false;
+        // a new statement handle will have the OCI default prefetch row count, but a handle from the statement
+        // cache keeps the prefetch row count of its last use
+        prefetch_rows = conn.useStmtCache() ? PREFETCH_UNKNOWN : PREFETCH_DEFAULT;
     }
 
     // returns 0=OK, -1=ERROR
@@ -145,8 +187,14 @@ public:
     // returns 0=OK, -1=ERROR (exception), 1=no data
     DLLLOCAL int fetch(ExceptionSink* xsink, unsigned rows = 1) {
         int status;
+        {
+            QoreOracleCallHelper call(conn, xsink);
+            if (call.check())
+                return -1;
+            status = OCIStmtFetch2(stmthp, conn.errhp, rows, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+        }
 
-        if ((status = OCIStmtFetch2(stmthp, conn.errhp, rows, OCI_FETCH_NEXT, 0, OCI_DEFAULT))) {
+        if (status) {
             if (status == OCI_NO_DATA) {
                 //printd(5, "QoreOracleStatement::fetch() this=%p no more data\n", this);
                 return 1;
@@ -167,9 +215,9 @@ public:
     }
 
     DLLLOCAL int defineByPos(OCIDefine*& defp, unsigned pos, void* valuep, int value_sz, unsigned short dty,
-            void* indp, ExceptionSink* xsink, ub4 mode = OCI_DEFAULT) {
-        return conn.checkerr(OCIDefineByPos(stmthp, &defp, conn.errhp, pos, valuep, value_sz, dty, indp, 0, 0, mode),
-            "QoreOracleStatement::defineByPos()", xsink);
+            void* indp, ExceptionSink* xsink, ub4 mode = OCI_DEFAULT, ub2* rlenp = nullptr) {
+        return conn.checkerr(OCIDefineByPos(stmthp, &defp, conn.errhp, pos, valuep, value_sz, dty, indp, rlenp, 0,
+            mode), "QoreOracleStatement::defineByPos()", xsink);
     }
 
     DLLLOCAL int bindByPos(OCIBind*& bndp, unsigned pos, void* valuep, int value_sz, unsigned short dty,
@@ -181,14 +229,28 @@ public:
     DLLLOCAL int prepare(QoreString& str, ExceptionSink* xsink) {
         int rc = QoreOracleSimpleStatement::prepare(str.c_str(), str.strlen(), xsink);
         if (!rc) {
+            // make sure that the first setPrefetch() call sets the attribute on a cached handle
+            if (cached)
+                prefetch_rows = PREFETCH_UNKNOWN;
+
             // see what kind of statement was prepared and set the flag accordingly
             ub2 stype;
             if (attrGet(&stype, OCI_ATTR_STMT_TYPE, xsink)) {
                 return -1;
             }
 
-            if (stype == OCI_STMT_SELECT) {
-                is_select = true;
+            switch (stype) {
+                case OCI_STMT_SELECT:
+                    is_select = true;
+                    break;
+                case OCI_STMT_INSERT:
+                case OCI_STMT_UPDATE:
+                case OCI_STMT_DELETE:
+#ifdef OCI_STMT_MERGE
+                case OCI_STMT_MERGE:
+#endif
+                    is_dml = true;
+                    break;
             }
         }
 
@@ -213,6 +275,16 @@ public:
         return 0;
     }
 
+    // returns true if all rows of the result set have been fetched
+    DLLLOCAL bool isFetchComplete() const {
+        return fetch_complete;
+    }
+
+    // sets the prefetch row count used when fetching all rows
+    DLLLOCAL void setBulkPrefetch(unsigned rows) {
+        bulk_prefetch = rows;
+    }
+
     DLLLOCAL unsigned getArraySize() const {
         return array_size;
     }
@@ -221,7 +293,9 @@ public:
         return (bool)array_size;
     }
 
-    DLLLOCAL QoreHashNode* fetchRow(OraResultSet& columns, ExceptionSink* xsink);
+    // if lobs is given, LOB values that can be read together with those of other rows are added to it and assigned
+    // when it is read
+    DLLLOCAL QoreHashNode* fetchRow(OraResultSet& columns, ExceptionSink* xsink, OraLobBatch* lobs = nullptr);
     DLLLOCAL QoreHashNode* fetchSingleRow(ExceptionSink* xsink);
     DLLLOCAL QoreListNode* fetchRows(OraResultSet& columns, int rows, ExceptionSink* xsink);
     DLLLOCAL QoreListNode* fetchRows(ExceptionSink* xsink);
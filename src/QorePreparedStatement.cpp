@@ -830,6 +830,13 @@ public:
         assert(!conn);
         conn = bn.stmt.getData();
 
+#ifdef HAVE_OCILOBARRAYWRITE
+        // locators, buffers and sizes of values written with a single array write
+        lhvec_t wlocs;
+        std::vector<void*> wbufs;
+        std::vector<oraub8> wlens;
+#endif
+
         ConstListIterator li(l);
         while (li.next()) {
             size_t ind = li.index();
@@ -871,6 +878,16 @@ public:
             const BinaryNode* b = n.get<const BinaryNode>();
             //printd(5, "%lu/%lu: descr: %p p: %p len: %lu\n", ind, l->size(), lhvec[ind], b->getPtr(), b->size());
 
+#ifdef HAVE_OCILOBARRAYWRITE
+            // values that can be written in one piece are written together after the loop
+            if (b->size() && b->size() <= LOB_ONE_PIECE_MAX) {
+                wlocs.push_back(lhvec[ind]);
+                wbufs.push_back((void*)b->getPtr());
+                wlens.push_back(b->size());
+                continue;
+            }
+#endif
+
             // write the buffer data into the CLOB
             if (conn->writeLob(lhvec[ind], (void*)b->getPtr(), b->size(), true,
                 "DynamicArrayBindBinaryBlob::setupBindImpl() write LOB", xsink)) {
@@ -878,6 +895,21 @@ public:
             }
         }
 
+#ifdef HAVE_OCILOBARRAYWRITE
+        // write all values in one round trip
+        if (!wlocs.empty()) {
+            ub4 iter = wlocs.size();
+            std::vector<oraub8> byte_amt(wlens);
+            std::vector<oraub8> char_amt(iter, 0);
+            std::vector<oraub8> offset(iter, 1);
+            if (conn->checkerr(OCILobArrayWrite(conn->svchp, conn->errhp, &iter, &wlocs[0], &byte_amt[0],
+                &char_amt[0], &offset[0], &wbufs[0], &wlens[0], OCI_ONE_PIECE, nullptr, nullptr, 0, SQLCS_IMPLICIT),
+                "DynamicArrayBindBinaryBlob::setupBindImpl() write LOBs", xsink)) {
+                return -1;
+            }
+        }
+#endif
+
         bn.dtype = SQLT_BLOB;
         bn.stmt.bindByPos(bn.bndp, pos, 0, sizeof(OCILobLocator*), SQLT_BLOB, xsink, 0, OCI_DATA_AT_EXEC);
 
@@ -1928,15 +1960,38 @@ QoreValue OraBindNode::getValue(bool horizontal, ExceptionSink* xsink) {
     return OraColumnValue::getValue(xsink, horizontal, true);
 }
 
-int QorePreparedStatement::execute(ExceptionSink* xsink, const char* who, int oci_flags) {
+int QorePreparedStatement::execute(ExceptionSink* xsink, const char* who, int oci_flags, int prefetch) {
     assert(conn.svchp);
+    // rows fetched ahead from a previous execution are discarded
+    if (fetch_ahead) {
+        fetch_ahead->stop(xsink);
+    }
     ub4 iters;
     if (is_select) {
         iters = 0;
+        // set the prefetch row count before the execute so that rows are returned with the execute call
+        if (!(oci_flags & OCI_DESCRIBE_ONLY) && setPrefetch(xsink, prefetch)) {
+            return -1;
+        }
     } else {
         iters = !array_size ? 1 : array_size;
     }
-    int status = OCIStmtExecute(conn.svchp, stmthp, conn.errhp, iters, 0, 0, 0, OCI_DEFAULT | oci_flags);
+    sword status;
+    {
+        QoreOracleCallHelper call(conn, xsink);
+        if (call.check()) {
+            return -1;
+        }
+        // the session NLS settings are made before the first statement executed on the session; an error is
+        // handled like an error executing the statement, so a connection lost while it was idle is reestablished
+        // and the statement is executed on the new session
+        if (conn.checkSessionSetup(status, xsink)) {
+            return -1;
+        }
+        if (status == OCI_SUCCESS || status == OCI_SUCCESS_WITH_INFO) {
+            status = OCIStmtExecute(conn.svchp, stmthp, conn.errhp, iters, 0, 0, 0, OCI_DEFAULT | oci_flags);
+        }
+    }
 
     //printd(5, "QoreOracleStatement::execute() stmthp: %p status: %d (OCI_ERROR: %d)\n", stmthp, status, OCI_ERROR);
     if (status == OCI_ERROR) {
@@ -1947,8 +2002,25 @@ int QorePreparedStatement::execute(ExceptionSink* xsink, const char* who, int oc
 
         assert(!*xsink);
 
+        // the statement handle has been recreated; restore the prefetch row count
+        if (is_select && !(oci_flags & OCI_DESCRIBE_ONLY) && setPrefetch(xsink, prefetch)) {
+            return -1;
+        }
+
         //printd(5, "QoreOracleStatement::execute() returned from OCILogon() status: %d\n", status);
-        status = OCIStmtExecute(conn.svchp, stmthp, conn.errhp, iters, 0, 0, 0, OCI_DEFAULT | oci_flags);
+        {
+            QoreOracleCallHelper call(conn, xsink);
+            if (call.check()) {
+                return -1;
+            }
+            // the session was recreated as well
+            if (conn.checkSessionSetup(status, xsink)) {
+                return -1;
+            }
+            if (status == OCI_SUCCESS || status == OCI_SUCCESS_WITH_INFO) {
+                status = OCIStmtExecute(conn.svchp, stmthp, conn.errhp, iters, 0, 0, 0, OCI_DEFAULT | oci_flags);
+            }
+        }
         if (status && conn.checkerr(status, who, xsink)) {
             return -1;
         }
@@ -1958,8 +2030,8 @@ int QorePreparedStatement::execute(ExceptionSink* xsink, const char* who, int oc
     return 0;
 }
 
-int QorePreparedStatement::exec(ExceptionSink* xsink) {
-    return execute(xsink, "QorePreparedStatement::exec()");
+int QorePreparedStatement::exec(ExceptionSink* xsink, int prefetch) {
+    return execute(xsink, "QorePreparedStatement::exec()", 0, prefetch);
 }
 
 int QorePreparedStatement::execDescribe(ExceptionSink* xsink) {
@@ -1970,6 +2042,10 @@ int QorePreparedStatement::execDescribe(ExceptionSink* xsink) {
 void QorePreparedStatement::clear(ExceptionSink* xsink) {
     //printd(5, "QorePreparedStatement::clear() this: %p\n", this);
 
+    if (fetch_ahead) {
+        fetch_ahead->stop(xsink);
+    }
+
     QoreOracleStatement::reset(xsink);
 
     // clear all nodes without deleting the values
@@ -1988,6 +2064,10 @@ void QorePreparedStatement::clear(ExceptionSink* xsink) {
 }
 
 void QorePreparedStatement::reset(ExceptionSink* xsink) {
+    if (fetch_ahead) {
+        fetch_ahead->stop(xsink);
+    }
+
     QoreOracleStatement::reset(xsink);
 
     for (node_list_t::iterator i = node_list.begin(), e = node_list.end(); i != e; ++i) {
@@ -2324,14 +2404,18 @@ QoreHashNode* QorePreparedStatement::selectRow(ExceptionSink* xsink) {
         return nullptr;
     }
 
-    if (exec(xsink))
+    if (exec(xsink, PREFETCH_SINGLE_ROW))
         return nullptr;
 
     return fetchSingleRow(xsink);
 }
 
 QoreValue QorePreparedStatement::execWithPrologue(ExceptionSink* xsink, bool rows, bool cols) {
-    if (exec(xsink)) {
+    // DML statements in autocommit mode are committed in the same round trip as the execute
+    bool commit_on_success = is_dml && ds->getAutoCommit();
+    // selects retrieve all rows, so the first bulk prefetch is returned with the execute
+    if (execute(xsink, "QorePreparedStatement::exec()", commit_on_success ? OCI_COMMIT_ON_SUCCESS : 0,
+        PREFETCH_BULK)) {
         return QoreValue();
     }
 
@@ -2349,22 +2433,84 @@ QoreValue QorePreparedStatement::execWithPrologue(ExceptionSink* xsink, bool row
         if (*xsink) {
             return QoreValue();
         }
-    } else if (hasOutput) {
-        rv = getOutputHash(rows, xsink);
     } else {
-        // get row count
-        int rc = affectedRows(xsink);
-        rv = *xsink ? QoreValue() : QoreValue(rc);
+        // implicit results (DBMS_SQL.RETURN_RESULT) can only be returned by PL/SQL blocks and procedure calls
+        ReferenceHolder<QoreListNode> irl(!is_dml ? getImplicitResults(rows, xsink) : nullptr, xsink);
+        if (*xsink) {
+            return QoreValue();
+        }
+
+        if (irl) {
+            // return implicit results in the output hash
+            QoreHashNode* h = hasOutput ? getOutputHash(rows, xsink) : new QoreHashNode;
+            if (h) {
+                rv = h;
+                h->setKeyValue("implicit_results", irl.release(), xsink);
+            }
+        } else if (hasOutput) {
+            rv = getOutputHash(rows, xsink);
+        } else {
+            // get row count
+            int rc = affectedRows(xsink);
+            rv = *xsink ? QoreValue() : QoreValue(rc);
+        }
     }
 
-    // commit transaction if autocommit set for datasource
-    if (ds->getAutoCommit()) {
+    // commit transaction if autocommit set for datasource and the commit was not already sent with the execute
+    if (!commit_on_success && ds->getAutoCommit()) {
         getData()->commit(xsink);
     }
 
     return *xsink ? QoreValue() : rv.release();
 }
 
+QoreListNode* QorePreparedStatement::getImplicitResults(bool rows, ExceptionSink* xsink) {
+#ifdef OCI_ATTR_IMPLICIT_RESULT_COUNT
+    ub4 count = 0;
+    if (attrGet(&count, OCI_ATTR_IMPLICIT_RESULT_COUNT, xsink)) {
+        return nullptr;
+    }
+    if (!count) {
+        return nullptr;
+    }
+
+    ReferenceHolder<QoreListNode> l(new QoreListNode, xsink);
+    while (true) {
+        OCIStmt* result;
+        ub4 rtype;
+        int status = OCIStmtGetNextResult(stmthp, conn.errhp, (void**)&result, &rtype, OCI_DEFAULT);
+        if (status == OCI_NO_DATA) {
+            break;
+        }
+        if (conn.checkerr(status, "QorePreparedStatement::getImplicitResults()", xsink)) {
+            return nullptr;
+        }
+        // only select results are returned as implicit results
+        if (rtype != OCI_RESULT_TYPE_SELECT) {
+            continue;
+        }
+
+        // the result handle belongs to this statement and must not be freed
+        QoreOracleStatement tstmt(ds, result);
+        ValueHolder v(xsink);
+        if (rows) {
+            v = tstmt.fetchRows(xsink);
+        } else {
+            v = tstmt.fetchColumns(false, xsink);
+        }
+        tstmt.release();
+        if (*xsink) {
+            return nullptr;
+        }
+        l->push(v.release(), xsink);
+    }
+
+    return l.release();
+#else
+    return nullptr;
+#endif
+}
+
 int QorePreparedStatement::affectedRows(ExceptionSink* xsink) {
     int rc = 0;
     getData()->checkerr(OCIAttrGet(stmthp, OCI_HTYPE_STMT, &rc, 0, OCI_ATTR_ROW_COUNT, getData()->errhp),
@@ -2374,19 +2520,42 @@ int QorePreparedStatement::affectedRows(ExceptionSink* xsink) {
 
 QoreHashNode* QorePreparedStatement::fetchRow(ExceptionSink* xsink) {
     assert(columns);
+    if (checkFetchAhead("fetchRow", xsink)) {
+        return nullptr;
+    }
     return QoreOracleStatement::fetchRow(*columns, xsink);
 }
 
 QoreListNode* QorePreparedStatement::fetchRows(int rows, ExceptionSink* xsink) {
     assert(columns);
+    // with the "fetch-ahead" option, the next batch of rows is fetched while the rows returned are processed
+    if (!fetch_ahead && conn.fetch_ahead && rows > 0) {
+        fetch_ahead = new QoreOracleFetchAhead(*this);
+    }
+    if (fetch_ahead) {
+        return fetch_ahead->fetchRows(rows, xsink);
+    }
     return QoreOracleStatement::fetchRows(*columns, rows, xsink);
 }
 
 QoreHashNode* QorePreparedStatement::fetchColumns(int rows, ExceptionSink* xsink) {
     assert(columns);
+    if (checkFetchAhead("fetchColumns", xsink)) {
+        return nullptr;
+    }
     return QoreOracleStatement::fetchColumns(*columns, rows, false, xsink);
 }
 
+int QorePreparedStatement::checkFetchAhead(const char* m, ExceptionSink* xsink) {
+    if (fetch_ahead && fetch_ahead->isPending()) {
+        xsink->raiseException("ORACLE-FETCH-AHEAD-ERROR", "SQLStatement::%s() cannot be called while rows fetched "
+            "ahead for SQLStatement::fetchRows() are pending; retrieve the remaining rows with "
+            "SQLStatement::fetchRows() instead", m);
+        return -1;
+    }
+    return 0;
+}
+
 QoreHashNode* QorePreparedStatement::describe(ExceptionSink* xsink) {
     assert(columns);
     return QoreOracleStatement::describe(*columns, xsink);
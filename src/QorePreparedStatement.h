@@ -264,6 +264,8 @@ protected:
     QoreString* str = nullptr;
     OraResultSet* columns = nullptr;
     QoreListNode* args_copy = nullptr;
+    // fetches rows ahead in a helper thread with the "fetch-ahead" option
+    QoreOracleFetchAhead* fetch_ahead = nullptr;
     bool hasOutput = false;
     bool defined = false;
 
@@ -289,6 +291,7 @@ public:
         assert(!columns);
         assert(!args_copy);
         assert(node_list.empty());
+        delete fetch_ahead;
     }
 
 #ifdef DEBUG
@@ -336,13 +339,15 @@ public:
         return c;
     }
 
-    DLLLOCAL int execute(ExceptionSink* xsink, const char* who, int oci_flags = 0);
+    // executes the statement; for selects, the prefetch row count is set before the execute so that up to
+    // "prefetch" rows are returned in the same round trip
+    DLLLOCAL int execute(ExceptionSink* xsink, const char* who, int oci_flags = 0, int prefetch = PREFETCH_DEFAULT);
 
     DLLLOCAL int bind(const QoreListNode* args, ExceptionSink* xsink);
     DLLLOCAL int bindPlaceholders(const QoreListNode* args, ExceptionSink* xsink);
     DLLLOCAL int bindValues(const QoreListNode* args, ExceptionSink* xsink);
 
-    DLLLOCAL int exec(ExceptionSink* xsink);
+    DLLLOCAL int exec(ExceptionSink* xsink, int prefetch = PREFETCH_DEFAULT);
 
     DLLLOCAL int execDescribe(ExceptionSink* xsink);
 
@@ -362,12 +367,24 @@ public:
     DLLLOCAL QoreListNode* fetchRows(int rows, ExceptionSink* xsink);
     DLLLOCAL QoreHashNode* fetchColumns(int rows, ExceptionSink* xsink);
 
+    // fetches rows without fetching ahead
+    DLLLOCAL QoreListNode* fetchRowsDirect(int rows, ExceptionSink* xsink) {
+        assert(columns);
+        return QoreOracleStatement::fetchRows(*columns, rows, xsink);
+    }
+
+    // raises an exception if rows fetched ahead are pending, as the cursor is already past them
+    DLLLOCAL int checkFetchAhead(const char* m, ExceptionSink* xsink);
+
     DLLLOCAL QoreHashNode* describe(ExceptionSink* xsink);
 
     DLLLOCAL QoreValue execWithPrologue(ExceptionSink* xsink, bool rows, bool cols = false);
 
     DLLLOCAL QoreHashNode* selectRow(ExceptionSink* xsink);
 
+    // returns a list of implicit results returned with DBMS_SQL.RETURN_RESULT or nullptr if there are none
+    DLLLOCAL QoreListNode* getImplicitResults(bool rows, ExceptionSink* xsink);
+
     // rows = true means get a list of hashes, otherwise the default is a hash of lists
     DLLLOCAL QoreHashNode* getOutputHash(bool rows, ExceptionSink* xsink);
 };
@@ -26,6 +26,7 @@
 #include "oracle.h"
 #include "oracle-module.h"
 #include "oracleobject.h"
+#include "OracleAsyncStatementPriv.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -52,6 +53,10 @@ DLLEXPORT char qore_module_license_str[] = "MIT";
 void init_oracle_functions(QoreNamespace& ns);
 QoreClass* initAQMessageClass(QoreNamespace& ns);
 QoreClass* initAQQueueClass(QoreNamespace& ns);
+QoreClass* initOracleLobClass(QoreNamespace& ns);
+QoreClass* initOracleLobInputStreamClass(QoreNamespace& ns);
+QoreClass* initOracleLobOutputStreamClass(QoreNamespace& ns);
+QoreClass* initOracleAsyncStatementClass(QoreNamespace& ns);
 
 DBIDriver* DBID_ORACLE = nullptr;
 
@@ -75,16 +80,25 @@ static int dbi_oracle_caps = (
 
 static int oracle_commit(Datasource* ds, ExceptionSink* xsink) {
    QoreOracleConnection& conn = ds->getPrivateDataRef<QoreOracleConnection>();
+   QoreOracleServerCallHelper sch(conn, xsink);
+   if (sch.check())
+      return -1;
    return conn.commit(xsink);
 }
 
 static int oracle_rollback(Datasource* ds, ExceptionSink* xsink) {
    QoreOracleConnection& conn = ds->getPrivateDataRef<QoreOracleConnection>();
+   QoreOracleServerCallHelper sch(conn, xsink);
+   if (sch.check())
+      return -1;
    return conn.rollback(xsink);
 }
 
 static QoreValue oracle_exec(Datasource* ds, const QoreString* qstr, const QoreListNode* args, ExceptionSink* xsink) {
     QorePreparedStatementHelper bg(ds, xsink);
+    QoreOracleServerCallHelper sch(bg.conn, xsink);
+    if (sch.check())
+        return 0;
 
     if (bg.prepare(qstr, args, true, xsink))
         return 0;
@@ -94,6 +108,9 @@ static QoreValue oracle_exec(Datasource* ds, const QoreString* qstr, const QoreL
 
 static QoreValue oracle_select(Datasource* ds, const QoreString* qstr, const QoreListNode* args, ExceptionSink* xsink) {
     QorePreparedStatementHelper bg(ds, xsink);
+    QoreOracleServerCallHelper sch(bg.conn, xsink);
+    if (sch.check())
+        return 0;
 
     if (bg.prepare(qstr, args, true, xsink))
         return 0;
@@ -103,6 +120,9 @@ static QoreValue oracle_select(Datasource* ds, const QoreString* qstr, const Qor
 
 static QoreValue oracle_exec_raw(Datasource* ds, const QoreString* qstr, ExceptionSink* xsink) {
     QorePreparedStatementHelper bg(ds, xsink);
+    QoreOracleServerCallHelper sch(bg.conn, xsink);
+    if (sch.check())
+        return 0;
 
     if (bg.prepare(qstr, 0, false, xsink))
         return 0;
@@ -112,6 +132,9 @@ static QoreValue oracle_exec_raw(Datasource* ds, const QoreString* qstr, Excepti
 
 static QoreHashNode* oracle_select_row(Datasource* ds, const QoreString* qstr, const QoreListNode* args, ExceptionSink* xsink) {
     QorePreparedStatementHelper bg(ds, xsink);
+    QoreOracleServerCallHelper sch(bg.conn, xsink);
+    if (sch.check())
+        return 0;
 
     if (bg.prepare(qstr, args, true, xsink))
         return 0;
@@ -121,6 +144,9 @@ static QoreHashNode* oracle_select_row(Datasource* ds, const QoreString* qstr, c
 
 static QoreValue oracle_exec_rows(Datasource* ds, const QoreString* qstr, const QoreListNode* args, ExceptionSink* xsink) {
     QorePreparedStatementHelper bg(ds, xsink);
+    QoreOracleServerCallHelper sch(bg.conn, xsink);
+    if (sch.check())
+        return 0;
 
     if (bg.prepare(qstr, args, true, xsink))
         return 0;
@@ -168,6 +194,7 @@ static int oracle_close(Datasource* ds) {
     QORE_TRACE("oracle_close()");
 
     QoreOracleConnection *conn = (QoreOracleConnection *)ds->getPrivateData();
+    conn->quiesce();
 
     delete conn;
 
@@ -179,6 +206,9 @@ static int oracle_close(Datasource* ds) {
 static QoreValue oracle_get_server_version(Datasource* ds, ExceptionSink* xsink) {
    // get private data structure for connection
    QoreOracleConnection& conn = ds->getPrivateDataRef<QoreOracleConnection>();
+   QoreOracleServerCallHelper sch(conn, xsink);
+   if (sch.check())
+      return 0;
    return conn.getServerVersion(xsink);
 }
 
@@ -202,6 +232,9 @@ static int oracle_stmt_prepare(SQLStatement* stmt, const QoreString &str, const
 
    QorePreparedStatement* bg = new QorePreparedStatement(stmt->getDatasource());
    stmt->setPrivateData(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->prepare(str, args, true, xsink);
 }
@@ -211,6 +244,9 @@ static int oracle_stmt_prepare_raw(SQLStatement* stmt, const QoreString &str, Ex
 
    QorePreparedStatement* bg = new QorePreparedStatement(stmt->getDatasource());
    stmt->setPrivateData(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->prepare(str, 0, false, xsink);
 }
@@ -218,6 +254,9 @@ static int oracle_stmt_prepare_raw(SQLStatement* stmt, const QoreString &str, Ex
 static int oracle_stmt_bind(SQLStatement* stmt, const QoreListNode& l, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->bind(&l, xsink);
 }
@@ -225,6 +264,9 @@ static int oracle_stmt_bind(SQLStatement* stmt, const QoreListNode& l, Exception
 static int oracle_stmt_bind_placeholders(SQLStatement* stmt, const QoreListNode& l, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->bindPlaceholders(&l, xsink);
 }
@@ -232,6 +274,9 @@ static int oracle_stmt_bind_placeholders(SQLStatement* stmt, const QoreListNode&
 static int oracle_stmt_bind_values(SQLStatement* stmt, const QoreListNode& l, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->bindValues(&l, xsink);
 }
@@ -239,6 +284,9 @@ static int oracle_stmt_bind_values(SQLStatement* stmt, const QoreListNode& l, Ex
 static int oracle_stmt_exec(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->exec(xsink);
 }
@@ -246,6 +294,9 @@ static int oracle_stmt_exec(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_stmt_exec_describe(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->execDescribe(xsink);
 }
@@ -253,6 +304,9 @@ static int oracle_stmt_exec_describe(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_stmt_define(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->define(xsink);
 }
@@ -260,6 +314,9 @@ static int oracle_stmt_define(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_stmt_affected_rows(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return -1;
 
    return bg->affectedRows(xsink);
 }
@@ -267,6 +324,9 @@ static int oracle_stmt_affected_rows(SQLStatement* stmt, ExceptionSink* xsink) {
 static QoreHashNode* oracle_stmt_get_output(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->getOutput(xsink);
 }
@@ -274,6 +334,9 @@ static QoreHashNode* oracle_stmt_get_output(SQLStatement* stmt, ExceptionSink* x
 static QoreHashNode* oracle_stmt_get_output_rows(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->getOutputRows(xsink);
 }
@@ -281,6 +344,9 @@ static QoreHashNode* oracle_stmt_get_output_rows(SQLStatement* stmt, ExceptionSi
 static QoreHashNode* oracle_stmt_fetch_row(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->fetchRow(xsink);
 }
@@ -288,6 +354,9 @@ static QoreHashNode* oracle_stmt_fetch_row(SQLStatement* stmt, ExceptionSink* xs
 static QoreListNode* oracle_stmt_fetch_rows(SQLStatement* stmt, int rows, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->fetchRows(rows, xsink);
 }
@@ -295,6 +364,9 @@ static QoreListNode* oracle_stmt_fetch_rows(SQLStatement* stmt, int rows, Except
 static QoreHashNode* oracle_stmt_fetch_columns(SQLStatement* stmt, int rows, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->fetchColumns(rows, xsink);
 }
@@ -302,6 +374,9 @@ static QoreHashNode* oracle_stmt_fetch_columns(SQLStatement* stmt, int rows, Exc
 static QoreHashNode* oracle_stmt_describe(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return 0;
 
    return bg->describe(xsink);
 }
@@ -309,6 +384,11 @@ static QoreHashNode* oracle_stmt_describe(SQLStatement* stmt, ExceptionSink* xsi
 static bool oracle_stmt_next(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   QoreOracleServerCallHelper sch(bg->conn, xsink);
+   if (sch.check())
+      return false;
+   if (bg->checkFetchAhead("next", xsink))
+      return false;
 
    return bg->next(xsink);
 }
@@ -316,6 +396,7 @@ static bool oracle_stmt_next(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_stmt_free(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   bg->conn.quiesce();
 
    // free all handles without closing the statement or freeing private data
    bg->clear(xsink);
@@ -325,6 +406,7 @@ static int oracle_stmt_free(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_stmt_close(SQLStatement* stmt, ExceptionSink* xsink) {
    QorePreparedStatement* bg = (QorePreparedStatement*)stmt->getPrivateData();
    assert(bg);
+   bg->conn.quiesce();
 
    bg->reset(xsink);
    delete bg;
@@ -335,6 +417,9 @@ static int oracle_stmt_close(SQLStatement* stmt, ExceptionSink* xsink) {
 static int oracle_opt_set(Datasource* ds, const char* opt, const QoreValue val, ExceptionSink* xsink) {
    // get private data structure for connection
    QoreOracleConnection& conn = ds->getPrivateDataRef<QoreOracleConnection>();
+   QoreOracleServerCallHelper sch(conn, xsink);
+   if (sch.check())
+      return -1;
    return conn.setOption(opt, val, xsink);
 }
 
@@ -352,6 +437,10 @@ QoreStringNode* oracle_module_init() {
    init_oracle_functions(OraNS);
    OraNS.addSystemClass(initAQMessageClass(OraNS));
    OraNS.addSystemClass(initAQQueueClass(OraNS));
+   OraNS.addSystemClass(initOracleLobClass(OraNS));
+   OraNS.addSystemClass(initOracleLobInputStreamClass(OraNS));
+   OraNS.addSystemClass(initOracleLobOutputStreamClass(OraNS));
+   OraNS.addSystemClass(initOracleAsyncStatementClass(OraNS));
 
    // register driver with DBI subsystem
    qore_dbi_method_list methods;
@@ -395,6 +484,27 @@ QoreStringNode* oracle_module_init() {
    methods.registerOption(DBI_OPT_NUMBER_STRING, "when set, number values are returned as strings for backwards-compatibility; the argument is ignored; setting this option turns it on and turns off 'optimal-numbers' and 'numeric-numbers'");
    methods.registerOption(DBI_OPT_NUMBER_NUMERIC, "when set, number values are returned as arbitrary-precision number values; the argument is ignored; setting this option turns it on and turns off 'string-numbers' and 'optimal-numbers'");
    methods.registerOption(DBI_OPT_TIMEZONE, "set the server-side timezone, value must be a string in the format accepted by Timezone::constructor() on the client (ie either a region name or a UTC offset like \"+01:00\"), if not set the server's time zone will be assumed to be the same as the client's", stringTypeInfo);
+   methods.registerOption(ORA_OPT_CURSOR_MODE, "set how nested cursors (CURSOR() expressions and result set output values) are returned; \"eager\" (the default): the cursor is fetched immediately and returned as data, \"statement\": the cursor is returned as an SQLStatement object and rows are only fetched on demand", stringTypeInfo);
+   methods.registerOption(ORA_OPT_CURSOR_PREFETCH, "set the prefetch row count for nested cursors fetched in \"eager\" mode; 0 (the default) means use the driver's default bulk prefetch row count", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_ZERO_COPY_STRINGS, "when set, fetch buffers for string and RAW column values that fill at least half of the buffer are handed to the value instead of being copied and a new buffer is allocated for the next row; this avoids copying long text and binary values at the cost of values potentially using more memory than needed", softBoolTypeInfo);
+   methods.registerOption(ORA_OPT_LOB_PREFETCH_SIZE, "set the LOB prefetch size in bytes for BLOB columns and characters for CLOB columns; LOB data up to this size is returned with the row data and read without additional round trips; 0 (the default) disables LOB prefetching", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_LOB_AS_LONG, "if true, CLOB and BLOB columns are fetched with the row data like LONG and LONG RAW columns instead of being read separately through LOB locators", softBoolTypeInfo);
+   methods.registerOption(ORA_OPT_LOB_MODE, "set how CLOB and BLOB values are returned; \"value\" (the default): the LOB data is read and returned as a string or binary value, \"locator\": the LOB is returned as an OracleLob object that can be read or written with an OracleLobInputStream or OracleLobOutputStream on the same connection", stringTypeInfo);
+   methods.registerOption(ORA_OPT_LONG_MAX_SIZE, "set the maximum size of LONG column values in bytes; the default is 10MB", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_SESSION_POOL, "if true, sessions are taken from an OCI session pool shared by all connections with the same login and session pool options instead of logging on for each connection; can only be set when the connection is opened", softBoolTypeInfo);
+   methods.registerOption(ORA_OPT_SESSION_POOL_MIN, "set the minimum number of sessions in the session pool; the default is 1; can only be set when the connection is opened", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_SESSION_POOL_MAX, "set the maximum number of sessions in the session pool; the default is 100; can only be set when the connection is opened", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_SESSION_POOL_INCREMENT, "set the number of sessions added to the session pool when it grows; the default is 1; can only be set when the connection is opened", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_SESSION_POOL_TIMEOUT, "set the number of seconds after which idle sessions are closed by the session pool; 0 (the default) means no timeout; can only be set when the connection is opened", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_DRCP, "if true, the connection is made to a Database Resident Connection Pooling (DRCP) pooled server by adding the \":POOLED\" suffix to easy connect strings; can only be set when the connection is opened", softBoolTypeInfo);
+   methods.registerOption(ORA_OPT_CONNECTION_CLASS, "set the DRCP connection class; pooled servers are only shared between sessions with the same connection class; can only be set when the connection is opened", stringTypeInfo);
+   methods.registerOption(ORA_OPT_PURITY, "set the DRCP session purity: \"default\", \"new\" (a new session without state from previous uses), or \"self\" (a session that may have state from previous uses); can only be set when the connection is opened", stringTypeInfo);
+   methods.registerOption(ORA_OPT_SERVER_MULTIPLEX, "set the maximum number of sessions sharing one server attachment with other connections to the same database with the same character encoding; 0 (the default) or 1 means that each connection attaches to the server itself; only one call can be in progress on a shared attachment at a time, so a long-running call blocks the other connections sharing it; can only be set when the connection is opened", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_CALL_TIMEOUT, "set the maximum time in milliseconds for executing statements and fetching rows; calls that take longer are interrupted and raise a DBI:ORACLE:CALL-TIMEOUT exception; with \"server-multiplex\", calls are not interrupted and the timeout only limits the wait for the shared server attachment; 0 (the default) means no timeout", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_CANCEL_KEY, "set a key for cancelling calls in progress on the connection from other threads with cancelOracleCalls(); cannot be used with \"server-multiplex\"; cancelled calls raise a DBI:ORACLE:CALL-CANCELLED exception", stringTypeInfo);
+   methods.registerOption(ORA_OPT_FETCH_AHEAD, "if true, SQLStatement::fetchRows() fetches the next batch of rows in a helper thread while the rows returned are processed", softBoolTypeInfo);
+   methods.registerOption(ORA_OPT_DECODE_THREADS, "set the number of threads converting the rows fetched by SQLStatement::fetchRows() and selectRows() into hashes; 0 (the default) or 1 means that rows are converted in the calling thread", softBigIntTypeInfo);
+   methods.registerOption(ORA_OPT_STMT_CACHE_SIZE, "set the size of the statement cache of pooled sessions; 0 disables statement caching; the default is 20; can only be set when the connection is opened", softBigIntTypeInfo);
 
    DBID_ORACLE = DBI.registerDriver("oracle", methods, dbi_oracle_caps);
 
@@ -408,4 +518,8 @@ void oracle_module_ns_init(QoreNamespace* rns, QoreNamespace* qns) {
 
 void oracle_module_delete() {
    QORE_TRACE("oracle_module_delete()");
+   oraCallMonitor.shutdown();
+   oraDecodePool.shutdown();
+   oraAsyncPool.shutdown();
+   QoreOracleEnvironment::cleanup();
 }
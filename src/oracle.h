@@ -44,6 +44,11 @@
 
 #include "OraColumnValue.h"
 #include "QoreOracleConnection.h"
+#include "QoreOracleSessionPool.h"
+#include "QoreOracleSharedServer.h"
+#include "QoreOracleCallMonitor.h"
+#include "QoreOracleFetchAhead.h"
+#include "QoreOracleDecodePool.h"
 #include "QoreOracleStatement.h"
 #include "QorePreparedStatement.h"
 #include "OraResultSet.h"
@@ -55,6 +60,9 @@
 
 #define ORA_RAW_SIZE 65535
 
+// maximum define buffer size for values defined with a (ub2) return length
+#define ORA_RLEN_MAX 65535
+
 /* note that some operations will work with VARCHAR2 values up to 32767 bytes long, however
    others will fail - basically VARCHAR2 columns cannot hold values > 4000 bytes and anything
    else should be a CLOB in order to make everything work best
@@ -71,6 +79,15 @@
 #define LOB_BLOCK_SIZE 16384
 #endif
 
+// target buffer size for piecewise LOB I/O; rounded down to a multiple of the LOB chunk size
+#define LOB_PIECE_SIZE (1024 * 1024)
+
+// LOB values up to this size are written with a single call
+#define LOB_ONE_PIECE_MAX (8 * 1024 * 1024)
+
+// the maximum number of LOB values of several rows read with one round trip by SQLStatement::fetchRows()
+#define LOB_ARRAY_READ_MAX 100
+
 // timestamp binding type
 #ifdef _QORE_HAS_TIME_ZONES
 // use timestamp with time zone if qore supports time zones
@@ -84,4 +101,11 @@
 // maximum string size for an oracle number
 #define ORACLE_NUMBER_STR_LEN 127
 
+// creates and opens a dedicated Oracle datasource from a hash of connection parameters
+DLLLOCAL Datasource* oracle_open_datasource(const QoreHashNode* opts, const char* err, ExceptionSink* xsink);
+
+// returns an OracleLob object with a copy of the given LOB locator for the "locator" LOB mode
+DLLLOCAL QoreValue oracle_get_lob_object(QoreOracleConnection* conn, OCILobLocator* lobp, bool clob,
+        const QoreEncoding* enc, ExceptionSink* xsink);
+
 #endif
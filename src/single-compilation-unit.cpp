@@ -1,13 +1,24 @@
 #include "ql_oracle.cpp"
 #include "QC_AQMessage.cpp"
 #include "QC_AQQueue.cpp"
+#include "QC_OracleLob.cpp"
+#include "QC_OracleLobInputStream.cpp"
+#include "QC_OracleLobOutputStream.cpp"
+#include "QC_OracleAsyncStatement.cpp"
 #include "oracle.cpp"
 #include "oracleobject.cpp"
 #include "QoreOracleConnection.cpp"
+#include "QoreOracleSessionPool.cpp"
+#include "QoreOracleSharedServer.cpp"
+#include "QoreOracleCallMonitor.cpp"
+#include "QoreOracleFetchAhead.cpp"
+#include "QoreOracleDecodePool.cpp"
 #include "QoreOracleStatement.cpp"
 #include "QorePreparedStatement.cpp"
 #include "OraColumnValue.cpp"
 #include "OraResultSet.cpp"
+#include "OracleLobStream.cpp"
+#include "OracleAsyncStatement.cpp"
 #include "ocilib/exception.cpp"
 #include "ocilib/string.cpp"
 #include "ocilib/timestamp.cpp"